@@ -12,3 +12,14 @@ The FPP Arcade plugin provides a few interactive games that can be played on a P
 </table>
 </div>
 </div>
+
+<p>
+"Start - Pressed" pauses the game being played and pressing it again resumes it.  "Select - Pressed" switches to the next game configured on the model; the game that was playing is put aside and picks up where it left off the next time it is started.  The same happens when something else, such as a scheduled effect, takes over the model in the middle of a game.  The "FPP Arcade Pause" command can Pause, Resume or Toggle a game, Suspend it (put it aside and free the model) or Discard the game that was put aside so the next one starts fresh.
+</p>
+
+<p>
+Pong and Tron can be played between two FPP instances.  Set Netplay to On for the game on both, give one Side 1 and the other Side 2, and set each one's Peer to the other's address and Port (for example "192.168.1.20:7531").  Both must use the same game settings and model size.  Only the button presses go over the network; each FPP runs the whole game and corrects itself when the other player's input arrives late.  Input Delay holds every press back that many frames, which hides that much network latency at the cost of a slightly slower feel.  Until the other side is there Pong scrolls WAITING FOR PLAYER and the other side's number, and Tron shows WAIT.  Both show LOST if the other side stops answering.  Netplay games can't be paused.
+</p>
+<p>
+To try it on one FPP, configure the game twice on two models: Side 1 on port 7531 with peer "127.0.0.1:7532" and Side 2 on port 7532 with peer "127.0.0.1:7531".  Test Latency and Test Loss delay and drop that share of the packets sent, to see how the game copes with a poor network.
+</p>
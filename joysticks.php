@@ -67,7 +67,6 @@ function SaveJoystickInputs() {
                     $('html,body').css('cursor','auto');
                     if (data.Status == 'OK') {
                         $.jGrowl("Joystick Inputs Saved.");
-                        SetRestartFlag(2);
                     } else {
                         alert('ERROR: ' + data.Message);
                     }
@@ -38,7 +38,8 @@ var arcadeConfig = <? echo json_encode($pluginJson, JSON_PRETTY_PRINT); ?>;
 function GetTetrisOptions() {
     var html = "Rows: <input type='number' value='20' min='1' max='50' class='option1' data-optionname='Rows'/>&nbsp;";
     html += "Colums: <input type='number' value='11' min='1' max='30' class='option2' data-optionname='Colums'/>&nbsp;";
-    html += "Pixel Scaling: <input type='number' value='1' min='1' max='20' class='option3' data-optionname='Pixel Scaling'/>";
+    html += "Pixel Scaling: <input type='number' value='1' min='1' max='20' class='option3' data-optionname='Pixel Scaling'/>&nbsp;";
+    html += "Initials: <select class='option4' data-optionname='Initials'><option value='No'>No</option><option value='Yes'>Yes</option></select>";
     return html;
 }
 function GetPongOptions() {
@@ -47,11 +48,46 @@ function GetPongOptions() {
     html += "<option value='1'>Up/Down and Left/Right</option>";
     html += "<option value='2'>UpLeft/DownLeft and UpRight/DownRight</option>";
     html += "<option value='3'>Up/Left and Right/Down </option>";
-    html += "</select>"
+    html += "</select>&nbsp;";
+    html += "Opponent: <select class='option3' data-optionname='Opponent'><option value='Human'>Human</option><option value='Computer'>Computer</option><option value='Attract'>Attract (Computer vs Computer)</option></select>&nbsp;";
+    html += "AI Reaction (ms): <input type='number' value='150' min='0' max='2000' class='option4' data-optionname='AI Reaction'/>&nbsp;";
+    html += "AI Error: <input type='number' value='2' min='0' max='50' class='option5' data-optionname='AI Error'/>";
+    html += GetNetplayOptions();
     return html;
 }
 function GetSnakeOptions() {
-    var html = "Pixel Scaling: <input type='number' value='1' min='1' max='20' class='option1' data-optionname='Pixel Scaling'/>";
+    var html = "Pixel Scaling: <input type='number' value='1' min='1' max='20' class='option1' data-optionname='Pixel Scaling'/>&nbsp;";
+    html += "Initials: <select class='option2' data-optionname='Initials'><option value='No'>No</option><option value='Yes'>Yes</option></select>";
+    return html;
+}
+function GetLifeOptions() {
+    var html = "Pixel Scaling: <input type='number' value='1' min='1' max='20' class='option1' data-optionname='Pixel Scaling'/>&nbsp;";
+    html += "Speed (ms): <input type='number' value='50' min='10' max='1000' class='option2' data-optionname='Speed'/>&nbsp;";
+    html += "Rule: <input type='text' size='10' value='B3/S23' class='option3' data-optionname='Rule'/>&nbsp;";
+    html += "Edges: <select class='option4' data-optionname='Edges'><option value='Wrap'>Wrap</option><option value='Dead'>Dead</option></select>";
+    return html;
+}
+function GetInvadersOptions() {
+    var html = "Pixel Scaling: <input type='number' value='1' min='1' max='20' class='option1' data-optionname='Pixel Scaling'/>&nbsp;";
+    html += "Initials: <select class='option2' data-optionname='Initials'><option value='No'>No</option><option value='Yes'>Yes</option></select>";
+    return html;
+}
+function GetTronOptions() {
+    var html = "Pixel Scaling: <input type='number' value='1' min='1' max='20' class='option1' data-optionname='Pixel Scaling'/>&nbsp;";
+    html += "Players: <input type='number' value='2' min='1' max='8' class='option2' data-optionname='Players'/>&nbsp;";
+    html += "Speed (ms): <input type='number' value='40' min='10' max='500' class='option3' data-optionname='Speed'/>&nbsp;";
+    html += "Rounds: <input type='number' value='3' min='1' max='20' class='option4' data-optionname='Rounds'/>";
+    html += GetNetplayOptions();
+    return html;
+}
+function GetNetplayOptions() {
+    var html = "<br>Netplay: <select class='option21' data-optionname='Netplay'><option value='Off'>Off</option><option value='On'>On</option></select>&nbsp;";
+    html += "Side: <select class='option22' data-optionname='Net Side'><option value='1'>1</option><option value='2'>2</option></select>&nbsp;";
+    html += "Port: <input type='number' value='7531' min='1024' max='65535' class='option23' data-optionname='Net Port'/>&nbsp;";
+    html += "Peer: <input type='text' size='20' placeholder='host:port' class='option24' data-optionname='Net Peer'/><br>";
+    html += "Input Delay (frames): <input type='number' value='2' min='0' max='8' class='option25' data-optionname='Input Delay'/>&nbsp;";
+    html += "Test Latency (ms): <input type='number' value='0' min='0' max='1000' class='option26' data-optionname='Net Test Latency'/>&nbsp;";
+    html += "Test Loss (%): <input type='number' value='0' min='0' max='90' class='option27' data-optionname='Net Test Loss'/>";
     return html;
 }
 function GetBreakoutOptions() {
@@ -70,6 +106,12 @@ function GameChanged(sel) {
         html = GetSnakeOptions();
     } else if (val == "Breakout") {
         html = GetBreakoutOptions();
+    } else if (val == "Life") {
+        html = GetLifeOptions();
+    } else if (val == "Invaders") {
+        html = GetInvadersOptions();
+    } else if (val == "Tron") {
+        html = GetTronOptions();
     }
     $(sel).parent().parent().find(".GameOptions").html(html);
 }
@@ -88,11 +130,24 @@ function AddArcade() {
     html += "<option value='Pong'>Pong</option>";
     html += "<option value='Snake'>Snake</option>";
     html += "<option value='Breakout'>Breakout</option>";
+    html += "<option value='Life'>Life</option>";
+    html += "<option value='Invaders'>Invaders</option>";
+    html += "<option value='Tron'>Tron</option>";
     html += "</select></td>";
     html += "<td><select class='model'>";
     html += modelOptions;
     html += "</select></td>";
     html += "<td><select class='overlayType'><option value='Overwrite'>Overwrite</option><option value='Transparent'>Transparent</option></select></td>";
+    html += "<td><input type='text' size='20' placeholder='Model2,Model3' class='option18' data-optionname='Span Models'/><br>";
+    html += "<select class='option19' data-optionname='Span Layout'><option value='Horizontal'>Horizontal</option><option value='Vertical'>Vertical</option><option value='Grid'>Grid</option></select>&nbsp;";
+    html += "Columns: <input type='number' value='1' min='1' max='32' class='option20' data-optionname='Span Columns'/><br>";
+    html += "Rotate: <select class='option14' data-optionname='Rotation'><option value='0'>0</option><option value='90'>90</option><option value='180'>180</option><option value='270'>270</option></select>&nbsp;";
+    html += "Mirror: <select class='option15' data-optionname='Mirror'><option value='None'>None</option><option value='Horizontal'>Horizontal</option><option value='Vertical'>Vertical</option><option value='Both'>Both</option></select><br>";
+    html += "Offset X: <input type='number' value='0' min='-1024' max='1024' class='option16' data-optionname='Offset X'/>&nbsp;";
+    html += "Offset Y: <input type='number' value='0' min='-1024' max='1024' class='option17' data-optionname='Offset Y'/><br>";
+    html += "Brightness: <input type='number' value='100' min='0' max='100' class='option11' data-optionname='Brightness'/>&nbsp;";
+    html += "Gamma: <input type='number' value='1.0' min='0.1' max='5' step='0.1' class='option12' data-optionname='Gamma'/>&nbsp;";
+    html += "Color Order: <select class='option13' data-optionname='Color Order'><option value='RGB'>RGB</option><option value='RBG'>RBG</option><option value='GRB'>GRB</option><option value='GBR'>GBR</option><option value='BRG'>BRG</option><option value='BGR'>BGR</option></select></td>";
     
     html += "<td class='GameOptions'>";
     html += GetTetrisOptions();
@@ -117,7 +172,7 @@ function SaveGame(row) {
 
     var options = [];
     var i = 0;
-    for (var x = 1; x <= 20; x++) {
+    for (var x = 1; x <= 30; x++) {
         var v = $(row).find('.option' + x);
         if (typeof v != "undefined") {
             var name = v.data('optionname');
@@ -143,6 +198,9 @@ function SaveGame(row) {
 
 function SaveArcade() {
     var arcadeConfig = { "games" : [] };
+    arcadeConfig["workerThreads"] = parseInt($('#workerThreads').val());
+    arcadeConfig["attractIdle"] = parseInt($('#attractIdle').val());
+    arcadeConfig["attractTime"] = parseInt($('#attractTime').val());
     var i = 0;
     $("#arcadeTableBody > tr").each(function() {
         arcadeConfig["games"][i++] = SaveGame(this);
@@ -158,7 +216,8 @@ function SaveArcade() {
         processData: false,
         contentType: 'application/json',
         success: function (data) {
-           SetRestartFlag(2);
+           // fppd watches the config file and applies the changes itself
+           $.jGrowl("Arcade games saved.");
         }
     });
 }
@@ -204,6 +263,15 @@ $(document).ready(function() {
 </script>
 <div>
 <table border=0>
+<tr><td colspan='2'>
+        Worker Threads: <input type='number' id='workerThreads' value='0' min='0' max='16' title='0 runs each game from FPP as before; otherwise all games are ticked together on this many threads'/>
+    </td>
+</tr>
+<tr><td colspan='2'>
+        Attract Mode After (s): <input type='number' id='attractIdle' value='0' min='0' max='3600' title='0 turns attract mode off; otherwise idle models cycle through demos of their games'/>&nbsp;
+        Each Demo (s): <input type='number' id='attractTime' value='60' min='10' max='3600'/>
+    </td>
+</tr>
 <tr><td colspan='2'>
         <input type="button" value="Save" class="buttons genericButton" onclick="SaveArcade();">
         <input type="button" value="Add" class="buttons genericButton" onclick="AddArcade();">
@@ -215,7 +283,7 @@ $(document).ready(function() {
 <div class='fppTableWrapper fppTableWrapperAsTable'>
 <div class='fppTableContents'>
 <table class="fppTable" id="arcadeTable"  width='100%'>
-<thead><tr class="fppTableHeader"><th>#</th><th>Enabled</th><th>Game</th><th>Model</th><th>Overlay</th><th>Options</th></tr></thead>
+<thead><tr class="fppTableHeader"><th>#</th><th>Enabled</th><th>Game</th><th>Model</th><th>Overlay</th><th>Layout</th><th>Options</th></tr></thead>
 <tbody id='arcadeTableBody'>
 </tbody>
 </table>
@@ -241,6 +309,16 @@ $.ajax({
                   
 
 
+if (arcadeConfig["workerThreads"] != null) {
+    $('#workerThreads').val(arcadeConfig["workerThreads"]);
+}
+if (arcadeConfig["attractIdle"] != null) {
+    $('#attractIdle').val(arcadeConfig["attractIdle"]);
+}
+if (arcadeConfig["attractTime"] != null) {
+    $('#attractTime').val(arcadeConfig["attractTime"]);
+}
+
 $.each(arcadeConfig["games"], function( key, val ) {
     var row = AddArcade();
     $(row).find('.enabled').prop('checked', val["enabled"]);
@@ -253,7 +331,7 @@ $.each(arcadeConfig["games"], function( key, val ) {
     GameChanged($(row).find('.game'));
 
     for (var i = 0; i < val['options'].length; i++) {
-       for (var y = 1; y <= 20; y++) {
+       for (var y = 1; y <= 30; y++) {
             var v = $(row).find('.option' + y);
            if (typeof v != "undefined") {
                var name = v.data('optionname');
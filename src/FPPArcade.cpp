@@ -19,7 +19,6 @@
 extern "C" {
 #include <SDL2/SDL.h>
 }
-#include "Timers.h"
 #endif
 #include <arpa/inet.h>
 #include <cstring>
@@ -27,9 +26,21 @@ extern "C" {
 #include <vector>
 #include <cmath>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <mutex>
+#include <tuple>
+#include <algorithm>
 
 #include "FPPArcade.h"
+#include "FPPArcadeMetrics.h"
+#include "FPPArcadeNetplay.h"
+#include "FPPArcadeScores.h"
+#include "FPPArcadeSnapshot.h"
+#include "FPPArcadeText.h"
+#include "FPPArcadeTrace.h"
+#include "FPPArcadeScheduler.h"
+#include "FPPArcadeRecorder.h"
+#include "FPPArcadeView.h"
 
 #include "commands/Commands.h"
 #include "fpphttp.h"
@@ -37,15 +48,11 @@ extern "C" {
 #include "settings.h"
 #include "Plugin.h"
 #include "log.h"
+#include "Timers.h"
 
 #include "overlays/PixelOverlayModel.h"
 #include "overlays/PixelOverlay.h"
 
-#include "FPPTetris.h"
-#include "FPPPong.h"
-#include "FPPSnake.h"
-#include "FPPBreakout.h"
-
 
 static std::vector<std::string> BUTTONS({
     "Up - Pressed", "Up - Released",
@@ -130,6 +137,7 @@ public:
     FPPArcadeCommand(FPPArcadePlugin *p) : Command("FPP Arcade Button"), plugin(p) {
         args.push_back(CommandArg("Button", "string", "Button").setContentList(BUTTONS));
         args.push_back(CommandArg("Target", "string", "Target").setContentListUrl("api/models?simple=true", true));
+        args.push_back(CommandArg("Player", "int", "Player", true).setDefaultValue("0").setRange(0, FPPArcadeGame::MAX_PLAYERS));
     }
     
     virtual std::unique_ptr<Command::Result> run(const std::vector<std::string> &args) override;
@@ -142,6 +150,7 @@ public:
         args.push_back(CommandArg("Axis", "string", "Axis").setContentList(AXIS));
         args.push_back(CommandArg("Target", "string", "Target").setContentListUrl("api/models?simple=true", true));
         args.push_back(CommandArg("Value", "int", "Value", true).setDefaultValue("0").setAdjustable().setRange(-32767, 32767));
+        args.push_back(CommandArg("Player", "int", "Player", true).setDefaultValue("0").setRange(0, FPPArcadeGame::MAX_PLAYERS));
     }
     
     virtual std::unique_ptr<Command::Result> run(const std::vector<std::string> &args) override;
@@ -159,19 +168,337 @@ public:
     FPPArcadePlugin *plugin;
 };
 
-FPPArcadeGame::FPPArcadeGame(Json::Value &c) : modelName(c["model"].asString()), config(c), idx(0) {
-    lastValues[0] = 0; lastValues[1] = 0;
+class FPPArcadeBrightnessCommand : public Command {
+public:
+    FPPArcadeBrightnessCommand(FPPArcadePlugin *p) : Command("FPP Arcade Brightness"), plugin(p) {
+        args.push_back(CommandArg("Brightness", "int", "Brightness", true).setDefaultValue("100").setAdjustable().setRange(0, 100));
+        args.push_back(CommandArg("Target", "string", "Target").setContentListUrl("api/models?simple=true", true));
+    }
+
+    virtual std::unique_ptr<Command::Result> run(const std::vector<std::string> &args) override;
+    FPPArcadePlugin *plugin;
+};
+
+class FPPArcadePauseCommand : public Command {
+public:
+    FPPArcadePauseCommand(FPPArcadePlugin *p) : Command("FPP Arcade Pause"), plugin(p) {
+        args.push_back(CommandArg("Action", "string", "Action").setContentList({"Toggle", "Pause", "Resume", "Suspend", "Discard"}));
+        args.push_back(CommandArg("Target", "string", "Target").setContentListUrl("api/models?simple=true", true));
+    }
+
+    virtual std::unique_ptr<Command::Result> run(const std::vector<std::string> &args) override;
+    FPPArcadePlugin *plugin;
+};
+
+class FPPArcadeRecordCommand : public Command {
+public:
+    FPPArcadeRecordCommand(FPPArcadePlugin *p) : Command("FPP Arcade Record"), plugin(p) {
+        args.push_back(CommandArg("Action", "string", "Action").setContentList({"Start", "Stop"}));
+        args.push_back(CommandArg("Target", "string", "Target").setContentListUrl("api/models?simple=true", false));
+        args.push_back(CommandArg("Sequence", "string", "Sequence Name", true).setDefaultValue(""));
+        args.push_back(CommandArg("StepTime", "int", "Step Time (ms)", true).setDefaultValue("25").setRange(10, 100));
+        args.push_back(CommandArg("MaxMinutes", "int", "Max Minutes", true).setDefaultValue("10").setRange(1, 120));
+    }
+
+    virtual std::unique_ptr<Command::Result> run(const std::vector<std::string> &args) override;
+    FPPArcadePlugin *plugin;
+};
+
+FPPArcadeGameOptions::FPPArcadeGameOptions(const Json::Value &config) :
+    model(config["model"].asString()),
+    game(config["game"].asString()) {
+    transparent = choiceOption(config, "overlay", {"Overwrite", "Transparent"}) == "Transparent";
+
+    std::string span = findOption(config, "Span Models");
+    size_t pos = 0;
+    while (pos <= span.size()) {
+        size_t end = span.find(',', pos);
+        if (end == std::string::npos) {
+            end = span.size();
+        }
+        std::string n = span.substr(pos, end - pos);
+        n.erase(0, n.find_first_not_of(" \t"));
+        n.erase(n.find_last_not_of(" \t") + 1);
+        if (!n.empty() && n != model) {
+            spanModels.push_back(n);
+        }
+        pos = end + 1;
+    }
+    std::string layout = choiceOption(config, "Span Layout", {"Horizontal", "Vertical", "Grid"});
+    if (layout == "Vertical") {
+        spanLayout = FPPArcadeCanvas::Layout::Vertical;
+    } else if (layout == "Grid") {
+        spanLayout = FPPArcadeCanvas::Layout::Grid;
+    }
+    spanColumns = intOption(config, "Span Columns", 1, 1, 32);
+
+    transform.rotation = std::atoi(choiceOption(config, "Rotation", {"0", "90", "180", "270"}).c_str());
+    std::string mirror = choiceOption(config, "Mirror", {"None", "Horizontal", "Vertical", "Both"});
+    transform.flipX = mirror == "Horizontal" || mirror == "Both";
+    transform.flipY = mirror == "Vertical" || mirror == "Both";
+    transform.offsetX = intOption(config, "Offset X", 0, -1024, 1024);
+    transform.offsetY = intOption(config, "Offset Y", 0, -1024, 1024);
+
+    brightness = intOption(config, "Brightness", 100, 0, 100);
+    gamma = floatOption(config, "Gamma", 1.0f, 0.1f, 5.0f);
+    colorOrder = choiceOption(config, "Color Order", {"RGB", "RBG", "GRB", "GBR", "BRG", "BGR"});
+    initials = choiceOption(config, "Initials", {"No", "Yes"}) == "Yes";
+}
+
+std::string FPPArcadeGameOptions::findOption(const Json::Value &config, const std::string &s, const std::string &def) {
+    if (config.isMember("options")) {
+        for (int x = 0; x < config["options"].size(); x++) {
+            if (config["options"][x]["name"].asString() == s) {
+                return config["options"][x]["value"].asString();
+            }
+        }
+    }
+    if (config.isMember(s)) {
+        return config[s].asString();
+    }
+    return def;
+}
+
+int FPPArcadeGameOptions::intOption(const Json::Value &config, const std::string &s, int def, int min, int max) const {
+    std::string v = findOption(config, s);
+    if (v.empty()) {
+        return def;
+    }
+    char *end = nullptr;
+    errno = 0;
+    long l = strtol(v.c_str(), &end, 10);
+    if (errno != 0 || end == v.c_str() || *end != 0) {
+        LogErr(VB_PLUGIN, "FPP Arcade %s on model %s: option \"%s\" value \"%s\" is not a number, using %d\n",
+               game.c_str(), model.c_str(), s.c_str(), v.c_str(), def);
+        return def;
+    }
+    if (l < min || l > max) {
+        LogErr(VB_PLUGIN, "FPP Arcade %s on model %s: option \"%s\" value %ld is outside %d-%d, using %d\n",
+               game.c_str(), model.c_str(), s.c_str(), l, min, max, def);
+        return def;
+    }
+    return l;
+}
+
+float FPPArcadeGameOptions::floatOption(const Json::Value &config, const std::string &s, float def, float min, float max) const {
+    std::string v = findOption(config, s);
+    if (v.empty()) {
+        return def;
+    }
+    char *end = nullptr;
+    float f = strtof(v.c_str(), &end);
+    if (end == v.c_str() || *end != 0) {
+        LogErr(VB_PLUGIN, "FPP Arcade %s on model %s: option \"%s\" value \"%s\" is not a number, using %.2f\n",
+               game.c_str(), model.c_str(), s.c_str(), v.c_str(), def);
+        return def;
+    }
+    if (f < min || f > max) {
+        LogErr(VB_PLUGIN, "FPP Arcade %s on model %s: option \"%s\" value %.2f is outside %.2f-%.2f, using %.2f\n",
+               game.c_str(), model.c_str(), s.c_str(), f, min, max, def);
+        return def;
+    }
+    return f;
+}
+
+std::string FPPArcadeGameOptions::choiceOption(const Json::Value &config, const std::string &s, const std::vector<std::string> &choices) const {
+    std::string v = findOption(config, s, choices[0]);
+    for (auto &c : choices) {
+        if (c == v) {
+            return v;
+        }
+    }
+    LogErr(VB_PLUGIN, "FPP Arcade %s on model %s: option \"%s\" value \"%s\" is not valid, using \"%s\"\n",
+           game.c_str(), model.c_str(), s.c_str(), v.c_str(), choices[0].c_str());
+    return choices[0];
+}
+
+void FPPArcadeGameOptions::netplayOptions(const Json::Value &config, FPPArcadeNetplayOptions &n) const {
+    n.enabled = choiceOption(config, "Netplay", {"Off", "On"}) == "On";
+    n.port = intOption(config, "Net Port", 7531, 1024, 65535);
+    n.peer = findOption(config, "Net Peer");
+    n.side = choiceOption(config, "Net Side", {"1", "2"}) == "2" ? 1 : 0;
+    n.inputDelay = intOption(config, "Input Delay", 2, 0, 8);
+    n.latency = intOption(config, "Net Test Latency", 0, 0, 1000);
+    n.loss = intOption(config, "Net Test Loss", 0, 0, 90);
+    if (n.enabled && n.peer.empty()) {
+        LogErr(VB_PLUGIN, "FPP Arcade %s on model %s: Netplay is on but \"Net Peer\" is empty, playing locally\n",
+               game.c_str(), model.c_str());
+        n.enabled = false;
+    }
+}
+
+FPPArcadeGame::FPPArcadeGame(Json::Value &c, const std::shared_ptr<FPPArcadeGameOptions> &o) : modelName(c["model"].asString()), config(c), options(o), idx(0) {
+    memset(lastValues, 0, sizeof(lastValues));
+    listenerId = "fpp-arcade-" + std::to_string((uintptr_t)this);
+    PixelOverlayManager::INSTANCE.addModelListener(modelName, listenerId, [this](PixelOverlayModel *m) {
+        invalidate();
+    });
+}
+
+FPPArcadeGameRegistry &FPPArcadeGameRegistry::INSTANCE() {
+    // function local so registrations from other translation units can't
+    // run before it is constructed
+    static FPPArcadeGameRegistry registry;
+    return registry;
+}
+
+void FPPArcadeGameRegistry::add(const std::string &name, const OptionsParser &parser, const Factory &factory) {
+    games.push_back({name, parser, factory});
+}
+
+const FPPArcadeGameRegistry::Entry *FPPArcadeGameRegistry::find(const std::string &name) const {
+    for (auto &g : games) {
+        if (g.name == name) {
+            return &g;
+        }
+    }
+    return nullptr;
+}
+
+void FPPArcadeGame::setOverlayState(PixelOverlayModel *m) {
+    if (!options->transparent) {
+        m->setState(PixelOverlayState(PixelOverlayState::PixelState::Enabled));
+    }
+}
+
+FPPArcadeGame::~FPPArcadeGame() {
+    PixelOverlayManager::INSTANCE.removeModelListener(modelName, listenerId);
+    FPPArcadeGameEffect *e = effect.exchange(nullptr);
+    if (e) {
+        e->owner = nullptr;
+    }
 }
 
 bool FPPArcadeGame::isRunning() {
-    PixelOverlayModel *m = PixelOverlayManager::INSTANCE.getModel(modelName);
-    if (m != nullptr) {
-        FPPArcadeGameEffect *effect = dynamic_cast<FPPArcadeGameEffect*>(m->getRunningEffect());
-        if (effect) {
-            return true;
+    return getEffect() != nullptr;
+}
+
+PixelOverlayModel *FPPArcadeGame::resolveModel() {
+    PixelOverlayModel *m = model;
+    if (m == nullptr) {
+        m = PixelOverlayManager::INSTANCE.getModel(modelName);
+        model = m;
+    }
+    return m;
+}
+
+FPPArcadeCanvas *FPPArcadeGame::createCanvas(PixelOverlayModel *m) {
+    FPPArcadeCanvas *c = buildCanvas(m);
+    activateCanvas(c);
+    return c;
+}
+
+FPPArcadeCanvas *FPPArcadeGame::buildCanvas(PixelOverlayModel *m) {
+    FPPArcadeCanvas *c;
+    if (options->spanModels.empty()) {
+        c = new FPPArcadeCanvas(m);
+    } else {
+        c = createSpanCanvas(m);
+    }
+    if (!options->transform.isIdentity()) {
+        c->setTransform(options->transform);
+    }
+    if (options->colorOrder != "RGB") {
+        c->setColorOrder(options->colorOrder);
+    }
+    if (options->gamma != 1.0f) {
+        c->setGamma(options->gamma);
+    }
+    int b = brightness;
+    c->setBrightness(b >= 0 ? b : options->brightness);
+    return c;
+}
+
+void FPPArcadeGame::activateCanvas(FPPArcadeCanvas *c) {
+    for (auto &p : c->getPanels()) {
+        setOverlayState(p.model);
+    }
+    if (options->transparent) {
+        c->setSparse(true);
+        c->setState(PixelOverlayState(PixelOverlayState::PixelState::Enabled));
+    }
+}
+
+void FPPArcadeGame::setBrightness(int b) {
+    brightness = b;
+    FPPArcadeGameEffect *e = getEffect();
+    if (e) {
+        e->setBrightness(b);
+    }
+}
+
+FPPArcadeCanvas *FPPArcadeGame::createSpanCanvas(PixelOverlayModel *m) {
+    std::vector<PixelOverlayModel*> models;
+    models.push_back(m);
+    for (auto &n : options->spanModels) {
+        PixelOverlayModel *sm = PixelOverlayManager::INSTANCE.getModel(n);
+        if (sm == nullptr) {
+            LogErr(VB_PLUGIN, "FPP Arcade %s on model %s: span model \"%s\" not found, skipping it\n",
+                   getName().c_str(), modelName.c_str(), n.c_str());
+            continue;
         }
+        models.push_back(sm);
+    }
+    return new FPPArcadeCanvas(models, options->spanLayout, options->spanColumns);
+}
+
+void FPPArcadeGame::startEffect(FPPArcadeGameEffect *e, int32_t firstUpdateMS) {
+    e->owner = this;
+    e->started = true;
+    e->askInitials = options->initials;
+    std::vector<uint8_t> s;
+    // sessions that won't be kept (netplay) don't resume one either
+    if (!e->demo && e->keepSession) {
+        std::lock_guard<std::mutex> l(snapshotLock);
+        s.swap(snapshot);
+    }
+    if (!s.empty()) {
+        uint64_t start = GetTimeMicros();
+        if (e->restore(s)) {
+            LogDebug(VB_PLUGIN, "FPP Arcade %s on model %s: resumed from a %d byte snapshot in %d us\n",
+                     getName().c_str(), modelName.c_str(), (int)s.size(), (int)(GetTimeMicros() - start));
+        } else {
+            LogWarn(VB_PLUGIN, "FPP Arcade %s on model %s: could not resume the suspended game, starting a new one\n",
+                    getName().c_str(), modelName.c_str());
+        }
+    }
+    effect = e;
+    e->model->setRunningEffect(e, firstUpdateMS);
+    e->schedule(firstUpdateMS);
+}
+
+void FPPArcadeGame::invalidate() {
+    model = nullptr;
+}
+
+void FPPArcadeGame::effectEnded(FPPArcadeGameEffect *e) {
+    FPPArcadeGameEffect *expected = e;
+    if (effect.compare_exchange_strong(expected, nullptr)) {
+        // the model may be going away with its effect, resolve it again next time
+        model = nullptr;
     }
-    return false;
+}
+
+FPPArcadeGameEffect *FPPArcadeGame::prepareDemo() {
+    // not cached, a demo that is discarded never runs so nothing would
+    // clear it again
+    PixelOverlayModel *m = PixelOverlayManager::INSTANCE.getModel(modelName);
+    if (m == nullptr) {
+        return nullptr;
+    }
+    FPPArcadeCanvas *c = buildCanvas(m);
+    FPPArcadeGameEffect *e = createDemo(c);
+    if (e == nullptr) {
+        delete c;
+        return nullptr;
+    }
+    e->demo = true;
+    return e;
+}
+
+void FPPArcadeGame::startDemo(FPPArcadeGameEffect *e) {
+    activateCanvas(e->getCanvas());
+    startEffect(e);
 }
 
 class ClearRunningEffect : public RunningEffect {
@@ -197,129 +524,408 @@ public:
 };
 
 void FPPArcadeGame::stop() {
-    PixelOverlayModel *m = PixelOverlayManager::INSTANCE.getModel(modelName);
-    if (m != nullptr) {
+    FPPArcadeGameEffect *e = getEffect();
+    if (e != nullptr) {
+        e->keepSession = false;
+        // replacing the effect deletes it which clears our handle
+        PixelOverlayModel *m = e->model;
+        m->setRunningEffect(new ClearRunningEffect(m), 10);
+    }
+}
+void FPPArcadeGame::suspend() {
+    FPPArcadeGameEffect *e = getEffect();
+    if (e != nullptr) {
+        // the effect hands its snapshot back from its destructor
+        PixelOverlayModel *m = e->model;
         m->setRunningEffect(new ClearRunningEffect(m), 10);
     }
 }
+bool FPPArcadeGame::isPaused() {
+    FPPArcadeGameEffect *e = getEffect();
+    return e != nullptr && e->isPaused();
+}
+void FPPArcadeGame::setPaused(bool p) {
+    FPPArcadeGameEffect *e = getEffect();
+    if (e != nullptr && !e->demo && e->canPause()) {
+        e->setPaused(p);
+    }
+}
+void FPPArcadeGame::togglePause() {
+    setPaused(!isPaused());
+}
+bool FPPArcadeGame::resume() {
+    if (getEffect() != nullptr) {
+        setPaused(false);
+        return true;
+    }
+    if (!hasSnapshot()) {
+        return false;
+    }
+    // starting a session picks the snapshot up
+    playerButton(0, "Start - Pressed");
+    return getEffect() != nullptr;
+}
+bool FPPArcadeGame::hasSnapshot() {
+    std::lock_guard<std::mutex> l(snapshotLock);
+    return !snapshot.empty();
+}
+void FPPArcadeGame::discardSnapshot() {
+    std::lock_guard<std::mutex> l(snapshotLock);
+    snapshot.clear();
+    snapshot.shrink_to_fit();
+}
+void FPPArcadeGame::keepSnapshot(std::vector<uint8_t> &&s) {
+    std::lock_guard<std::mutex> l(snapshotLock);
+    snapshot = std::move(s);
+}
+void FPPArcadeGame::input(const std::string &btn, int player) {
+    if (isPaused()) {
+        // nothing moves until the game is resumed
+        return;
+    }
+    const FPPArcadeCanvas::Transform &t = options->transform;
+    if (t.rotation == 0 && !t.flipX && !t.flipY) {
+        playerButton(player, btn);
+        return;
+    }
+    size_t dash = btn.find(" - ");
+    if (dash == std::string::npos) {
+        playerButton(player, btn);
+        return;
+    }
+    std::string dir = btn.substr(0, dash);
+    int dx = 0;
+    int dy = 0;
+    if (dir.compare(0, 2, "Up") == 0) {
+        dy = -1;
+    } else if (dir.compare(0, 4, "Down") == 0) {
+        dy = 1;
+    }
+    if (dir.find("Left") != std::string::npos) {
+        dx = -1;
+    } else if (dir.find("Right") != std::string::npos) {
+        dx = 1;
+    }
+    if (dx == 0 && dy == 0) {
+        // Fire/Select/Start
+        playerButton(player, btn);
+        return;
+    }
+    t.mapDirection(dx, dy);
+    std::string mapped = dy < 0 ? "Up" : (dy > 0 ? "Down" : "");
+    if (dx != 0) {
+        if (!mapped.empty()) {
+            mapped += "/";
+        }
+        mapped += dx < 0 ? "Left" : "Right";
+    }
+    playerButton(player, mapped + btn.substr(dash));
+}
+
 //default behavior will map the axis directions to button presses
-void FPPArcadeGame::axis(const std::string &axis, int value) {
+void FPPArcadeGame::axis(const std::string &axis, int value, int player) {
+    int *last = lastValues[std::clamp(player, 0, MAX_PLAYERS)];
     std::string btn = "";
     if (axis == AXIS[2]) { // DOWN->UP
-        if (value == 0 && lastValues[0] < 0) {
+        if (value == 0 && last[0] < 0) {
             btn = "Down - Released";
-        } else if (value == 0 && lastValues[0] > 0) {
+        } else if (value == 0 && last[0] > 0) {
             btn = "Up - Released";
         } else if (value != 0) {
             btn = value > 0 ? "Up - Pressed" : "Down - Pressed";
         }
-        lastValues[0] = value;
+        last[0] = value;
     } else if (axis == AXIS[1]) { // left -> right
-        if (value == 0 && lastValues[1] < 0) {
+        if (value == 0 && last[1] < 0) {
             btn = "Left - Released";
-        } else if (value == 0 && lastValues[1] > 0) {
+        } else if (value == 0 && last[1] > 0) {
             btn = "Right - Released";
         } else if (value != 0) {
             btn = value > 0 ? "Right - Pressed" : "Left - Pressed";
         }
-        lastValues[1] = value;
+        last[1] = value;
     } else if (axis == AXIS[0]) { // up -> down
-        if (value == 0 && lastValues[0] < 0) {
+        if (value == 0 && last[0] < 0) {
             btn = "Up - Released";
-        } else if (value == 0 && lastValues[0] > 0) {
+        } else if (value == 0 && last[0] > 0) {
             btn = "Down - Released";
         } else if (value != 0) {
             btn = value < 0 ? "Up - Pressed" : "Down - Pressed";
         }
-        lastValues[0] = value;
+        last[0] = value;
     } else if (axis == AXIS[3]) { // right -> left
-        if (value == 0 && lastValues[1] < 0) {
+        if (value == 0 && last[1] < 0) {
             btn = "Right - Released";
-        } else if (value == 0 && lastValues[1] > 0) {
+        } else if (value == 0 && last[1] > 0) {
             btn = "Left - Released";
         } else if (value != 0) {
             btn = value < 0 ? "Right - Pressed" : "Left - Pressed";
         }
-        lastValues[1] = value;
+        last[1] = value;
     }
     if (btn != "") {
-        button(btn);
+        input(btn, player);
     }
 }
 
 
-std::string FPPArcadeGame::findOption(const std::string &s, const std::string &def) {
-    if (config.isMember("options")) {
-        for (int x = 0; x < config["options"].size(); x++) {
-            if (config["options"][x]["name"].asString() == s) {
-                return config["options"][x]["value"].asString();
-            }
-        }
+
+FPPArcadeGameEffect::FPPArcadeGameEffect(FPPArcadeCanvas *c) : RunningEffect(c->getPrimaryModel()), scale(1), offsetX(0), offsetY(0), canvas(c) {
+}
+FPPArcadeGameEffect::~FPPArcadeGameEffect() {
+    detachFromScheduler();
+    FPPArcadeGame *o = owner.exchange(nullptr);
+    if (o) {
+        o->effectEnded(this);
     }
-    if (config.isMember(s)) {
-        return config[s].asString();
+    if (metrics) {
+        metrics->ended.inc();
+    }
+    if (!started) {
+        return;
+    }
+    // FPP only cleans up the primary model when the effect is replaced,
+    // blank the rest of the span ourselves
+    auto &panels = canvas->getPanels();
+    for (int x = 1; x < panels.size(); x++) {
+        panels[x].model->clearOverlayBuffer();
+        panels[x].model->flushOverlayBuffer();
+        panels[x].model->setState(PixelOverlayState(PixelOverlayState::PixelState::Disabled));
     }
-    return def;
 }
+// how often FPP polls an effect that the arcade scheduler is running
+static constexpr int32_t SCHEDULED_POLL_MS = 20;
+// tick interval while particles are alive
+static constexpr int32_t PARTICLE_FRAME_MS = 33;
 
+int32_t FPPArcadeGameEffect::update() {
+    if (scheduled) {
+        return SCHEDULED_POLL_MS;
+    }
+    if (hasScheduledResult) {
+        hasScheduledResult = false;
+        return scheduledResult;
+    }
+    return tick();
+}
+void FPPArcadeGameEffect::schedule(int32_t firstUpdateMS) {
+    if (FPPArcadeScheduler::INSTANCE.isEnabled()) {
+        scheduled = true;
+        onScheduler = true;
+        FPPArcadeScheduler::INSTANCE.add(this, firstUpdateMS);
+    }
+}
+void FPPArcadeGameEffect::detachFromScheduler() {
+    // even if the game already finished, remove() waits out the frame that
+    // finished it
+    if (onScheduler.exchange(false)) {
+        scheduled = false;
+        FPPArcadeScheduler::INSTANCE.remove(this);
+    }
+}
+void FPPArcadeGameEffect::finishScheduled(int32_t result) {
+    scheduledResult = result;
+    hasScheduledResult = true;
+    scheduled = false;
+}
+// how often a paused effect checks for being resumed
+static constexpr int32_t PAUSED_POLL_MS = 100;
 
-static const std::map<uint8_t, std::vector<uint8_t>> LETTERS = {
-    {'G', {1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1}},
-    {'A', {1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1}},
-    {'M', {1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1}},
-    {'E', {1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1}},
-    {'O', {1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1}},
-    {'V', {1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 0, 1, 0}},
-    {'R', {1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1}},
+int32_t FPPArcadeGameEffect::tick() {
+    if (paused) {
+        // keeps the dimmed picture on the models, the game itself stands
+        // still and the gap isn't counted as skipped frames
+        lastRequested = 0;
+        present();
+        return PAUSED_POLL_MS;
+    }
+    uint64_t start = GetTimeMicros();
+    if (metrics == nullptr) {
+        // name() can't be called from the constructor so look it up on the first tick
+        metrics = FPPArcadeMetrics::INSTANCE.getGameMetrics(name());
+        metrics->started.inc();
+    } else if (lastRequested > 0) {
+        uint64_t actual = start - lastTick;
+        uint64_t requested = lastRequested * 1000;
+        metrics->requestedInterval.observe(requested);
+        metrics->actualInterval.observe(actual);
+        if (actual >= requested * 2) {
+            metrics->framesSkipped.inc(actual / requested - 1);
+        }
+    }
+    uint64_t now = start / 1000;
+    if (particles.size()) {
+        particles.step(std::min(now - lastParticleMS, (uint64_t)100));
+    }
+    lastParticleMS = now;
 
-    {'Y', {1, 0, 1, 1, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
-    {'U', {1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1}},
-    {'W', {1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1}},
-    {'I', {0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
-    {'N', {1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1}},
+    int32_t ret;
+    // the game only sits out ticks that are there for the particles
+    bool gameDue = !particleTick || now >= nextGameMS;
+    if (gameDue) {
+        ARCADE_TRACE("update");
+        ret = updateGame();
+        nextGameMS = ret > 0 ? now + ret : 0;
+    } else {
+        // only the particles have moved since the game's last frame
+        present();
+        ret = nextGameMS - now;
+    }
+    particleTick = particles.size() && ret > PARTICLE_FRAME_MS;
+    if (particleTick) {
+        ret = PARTICLE_FRAME_MS;
+    }
+    lastTick = GetTimeMicros();
+    lastRequested = ret;
+    if (gameDue) {
+        metrics->updateTime.observe(lastTick - start);
+    }
+    if (ret == 0) {
+        finished = true;
+    }
+    return ret;
+}
+void FPPArcadeGameEffect::setBrightness(int b) {
+    std::lock_guard<std::mutex> l(pauseLock);
+    if (paused) {
+        pausedBrightness = b;
+        b /= 4;
+    }
+    canvas->setBrightness(b);
+}
+void FPPArcadeGameEffect::setPaused(bool p) {
+    std::lock_guard<std::mutex> l(pauseLock);
+    if (paused == p) {
+        return;
+    }
+    // dimming only rebuilds the palette lookup, the picture is untouched
+    if (p) {
+        pausedBrightness = canvas->getBrightness();
+        canvas->setBrightness(pausedBrightness / 4);
+    } else {
+        canvas->setBrightness(pausedBrightness);
+    }
+    paused = p;
+}
 
-    
-    {'0', {1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1}},
-    {'1', {0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
-    {'2', {1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1}},
-    {'3', {1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1}},
-    {'4', {1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0, 1}},
-    {'5', {1, 1, 1, 1, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 1}},
-    {'6', {1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1}},
-    {'7', {1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1}},
-    {'8', {1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1}},
-    {'9', {1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0, 1}},
-
-    {':', {0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0}}
-};
+// bumped whenever the layout of the base part of the image changes
+static constexpr uint32_t SNAPSHOT_MAGIC = 0x41504602;
 
-class Letter {
-public:
-    Letter(int l) {
-        set(l);
+bool FPPArcadeGameEffect::snapshot(std::vector<uint8_t> &out) {
+    FPPArcadeSnapshot s;
+    uint32_t magic = SNAPSHOT_MAGIC;
+    std::string n = name();
+    int w = getWidth();
+    int h = getHeight();
+    s.io(magic);
+    s.io(n);
+    s.io(w);
+    s.io(h);
+    s.io(scale);
+    s.io(offsetX);
+    s.io(offsetY);
+    if (!serialize(s)) {
+        return false;
     }
-    
-    uint8_t get(int x, int y) {
-        return data[y * 3 + x];
+    canvas->serialize(s);
+    out.swap(s.getData());
+    return true;
+}
+bool FPPArcadeGameEffect::readHeader(FPPArcadeSnapshot &s) {
+    uint32_t magic = 0;
+    std::string n;
+    int w = 0;
+    int h = 0;
+    int sc = 0;
+    int ox = 0;
+    int oy = 0;
+    s.io(magic);
+    s.io(n);
+    s.io(w);
+    s.io(h);
+    s.io(sc);
+    s.io(ox);
+    s.io(oy);
+    return s.isValid() && magic == SNAPSHOT_MAGIC && n == name()
+        && w == getWidth() && h == getHeight() && sc == scale && ox == offsetX && oy == offsetY;
+}
+bool FPPArcadeGameEffect::restore(const std::vector<uint8_t> &in) {
+    // Everything the options decide is checked before any state is
+    // touched, the image has to come from the same model size, scaling
+    // and placement.
+    FPPArcadeSnapshot s(in);
+    if (!readHeader(s)) {
+        return false;
     }
-    void set(int x, int y, uint8_t d) {
-        data[y * 3 + x] = d;
+    // Game options that aren't in the header (board rows, players) can
+    // still make the game's part fail half way, so keep the fresh state
+    // to go back to.
+    std::vector<uint8_t> fresh;
+    if (!snapshot(fresh)) {
+        return false;
     }
-private:
-    void set(int l) {
-        auto it = LETTERS.find(l);
-        if (it != LETTERS.end()) {
-            data = it->second;
+    if (serialize(s)) {
+        canvas->serialize(s);
+        if (s.isValid()) {
+            return true;
         }
     }
-    
-    std::vector<uint8_t> data;
-};
-FPPArcadeGameEffect::FPPArcadeGameEffect(PixelOverlayModel *m) : RunningEffect(m), scale(1), offsetX(0), offsetY(0) {
+    FPPArcadeSnapshot back(fresh);
+    readHeader(back);
+    serialize(back);
+    canvas->serialize(back);
+    return false;
 }
-FPPArcadeGameEffect::~FPPArcadeGameEffect() {
+uint32_t FPPArcadeGameEffect::stateHash() {
+    FPPArcadeSnapshot s;
+    serialize(s);
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (auto b : s.getData()) {
+        h = (h ^ b) * 16777619u;
+    }
+    return h;
+}
+void FPPArcadeGameEffect::saveSession() {
+    if (!started || demo || finished || !keepSession) {
+        return;
+    }
+    FPPArcadeGame *o = owner;
+    std::vector<uint8_t> s;
+    if (o && snapshot(s)) {
+        o->keepSnapshot(std::move(s));
+    }
+}
+void FPPArcadeGameEffect::present() {
+    if (FPPArcadeScheduler::inFrame()) {
+        presentPending = true;
+        return;
+    }
+    ARCADE_TRACE("flush");
+    particles.draw(canvas.get());
+    uint64_t start = GetTimeMicros();
+    bool changed = canvas->present();
+    if (metrics) {
+        if (changed) {
+            metrics->presentTime.observe(GetTimeMicros() - start);
+        } else {
+            metrics->presentsUnchanged.inc();
+        }
+    }
+    particles.undraw(canvas.get());
+}
+void FPPArcadeGameEffect::flushPresent() {
+    if (presentPending.exchange(false)) {
+        present();
+    }
+}
+void FPPArcadeGameEffect::disable() {
+    canvas->setState(PixelOverlayState(PixelOverlayState::PixelState::Disabled));
 }
 void FPPArcadeGameEffect::outputPixel(int x, int y, int r, int g, int b, int scl) {
+    outputPixel(x, y, canvas->color(r, g, b), scl);
+}
+void FPPArcadeGameEffect::outputPixel(int x, int y, uint8_t c, int scl) {
     if (scl == -1) {
         scl = scale;
     }
@@ -329,72 +935,183 @@ void FPPArcadeGameEffect::outputPixel(int x, int y, int r, int g, int b, int scl
     y += offsetY;
     for (int nx = 0; nx < scl; nx++) {
         for (int ny = 0; ny < scl; ny++) {
-            model->setOverlayPixelValue(x + nx, y + ny, r, g, b);
+            canvas->setPixel(x + nx, y + ny, c);
         }
     }
 }
+void FPPArcadeGameEffect::burst(int x, int y, int count, int r, int g, int b, float speed, int lifeMS) {
+    float px = x * scale + offsetX + scale / 2.0f;
+    float py = y * scale + offsetY + scale / 2.0f;
+    particles.burst(px, py, count, r, g, b, speed * scale, lifeMS, speed * scale * 2);
+}
+void FPPArcadeGameEffect::burstIndex(int x, int y, int count, uint8_t c, float speed, int lifeMS) {
+    uint32_t rgb = canvas->getPaletteColor(c);
+    burst(x, y, count, (rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF, speed, lifeMS);
+}
 void FPPArcadeGameEffect::outputLetter(int x, int y, char l, int r, int g, int b, int scl) {
-    Letter letter(l);
-    for (int nx = 0; nx < 3; nx++) {
-        for (int ny = 0; ny < 5; ny++) {
-            if (letter.get(nx, ny)) {
-                outputPixel(x + nx, y + ny, r, g, b, scl);
+    // characters without a glyph draw as a space
+    const uint8_t *glyph = FPPArcadeText::glyph(l);
+    if (glyph == nullptr) {
+        return;
+    }
+    uint8_t c = canvas->color(r, g, b);
+    for (int nx = 0; nx < FPPArcadeText::GLYPH_WIDTH; nx++) {
+        for (int ny = 0; ny < FPPArcadeText::GLYPH_HEIGHT; ny++) {
+            if (glyph[ny * FPPArcadeText::GLYPH_WIDTH + nx]) {
+                outputPixel(x + nx, y + ny, c, scl);
             }
         }
     }
 }
+// give up on initials entry after this long without a button
+static constexpr uint64_t INITIALS_TIMEOUT_MS = 30000;
+
+bool FPPArcadeGameEffect::gameOver(int score) {
+    if (demo || score <= 0) {
+        return false;
+    }
+    const std::string &model = canvas->getPrimaryModel()->getName();
+    if (askInitials && FPPArcadeScores::INSTANCE.qualifies(model, name(), score)) {
+        std::lock_guard<std::mutex> l(initialsLock);
+        initialsScore = score;
+        initials = "AAA";
+        initialsPos = 0;
+        initialsDeadline = GetTimeMS() + INITIALS_TIMEOUT_MS;
+        initialsActive = true;
+        return true;
+    }
+    FPPArcadeScores::INSTANCE.submit(model, name(), score, "");
+    return false;
+}
+
+int32_t FPPArcadeGameEffect::updateInitials() {
+    std::lock_guard<std::mutex> l(initialsLock);
+    uint64_t now = GetTimeMS();
+    if (initialsPos >= 3 || now >= initialsDeadline) {
+        FPPArcadeScores::INSTANCE.submit(canvas->getPrimaryModel()->getName(), name(), initialsScore, initials);
+        initialsActive = false;
+        return 1;
+    }
+    // the whole surface, whatever part of it the game uses
+    int ox = offsetX;
+    int oy = offsetY;
+    offsetX = offsetY = 0;
+    int cols = getWidth() / scale;
+    int rows = getHeight() / scale;
+    clear();
+    std::string s = std::to_string(initialsScore);
+    outputString(s, (cols - (int)s.size() * 4) / 2, rows / 2 - 9, 255, 255, 0);
+    int x = (cols - 11) / 2;
+    outputString(initials, x, rows / 2 - 2);
+    if ((now / 250) % 2) {
+        for (int i = 0; i < 3; i++) {
+            outputPixel(x + initialsPos * 4 + i, rows / 2 + 4, 255, 255, 255);
+        }
+    }
+    offsetX = ox;
+    offsetY = oy;
+    present();
+    return 50;
+}
+
+// Up/Down change the letter, Left/Right move, Fire takes the letter and
+// moves on, the last one finishes
+bool FPPArcadeGameEffect::initialsButton(const std::string &button) {
+    if (!initialsActive) {
+        return false;
+    }
+    std::lock_guard<std::mutex> l(initialsLock);
+    if (initialsPos >= 3) {
+        return true;
+    }
+    char &c = initials[initialsPos];
+    if (button == "Up - Pressed") {
+        c = c == 'Z' ? 'A' : c + 1;
+    } else if (button == "Down - Pressed") {
+        c = c == 'A' ? 'Z' : c - 1;
+    } else if (button == "Left - Pressed") {
+        initialsPos = std::max(0, initialsPos - 1);
+    } else if (button == "Right - Pressed") {
+        initialsPos = std::min(2, initialsPos + 1);
+    } else if (button == "Fire - Pressed") {
+        initialsPos++;
+    }
+    initialsDeadline = GetTimeMS() + INITIALS_TIMEOUT_MS;
+    return true;
+}
 void FPPArcadeGameEffect::outputString(const std::string &s, int x, int y, int r, int g, int b, int scl) {
+    ARCADE_TRACE("text");
     for (auto ch : s) {
         outputLetter(x, y, ch, r, g, b, scl);
         x += 4;
     }
 }
 
-class FPPArcadePlugin : public FPPPlugins::Plugin, public FPPPlugins::APIProviderPlugin {
+// One configured game on a model.  The options are parsed when the config
+// is loaded but the game itself is only created the first time it is used.
+class FPPArcadeGameSlot {
+public:
+    FPPArcadeGameSlot(const FPPArcadeGameRegistry::Entry *t, const Json::Value &c, int i) :
+        type(t), config(c), options(t->parseOptions(c)), idx(i) {}
+
+    const std::string &getName() const { return type->name; }
+    int getIdx() const { return idx; }
+    void setIdx(int i) {
+        idx = i;
+        if (game) {
+            game->setIdx(i);
+        }
+    }
+
+    FPPArcadeGame *get() {
+        if (!game) {
+            game.reset(type->create(config, options));
+            game->setIdx(idx);
+            if (brightness >= 0) {
+                game->setBrightness(brightness);
+            }
+        }
+        return game.get();
+    }
+    // kept here so games that haven't been created yet pick it up when
+    // they are
+    void setBrightness(int b) {
+        brightness = b;
+        if (game) {
+            game->setBrightness(b);
+        }
+    }
+    bool isRunning() const {
+        return game && game->isRunning();
+    }
+    bool isPaused() const {
+        return game && game->isPaused();
+    }
+    void stop() {
+        if (game) {
+            game->stop();
+        }
+    }
+
+    const FPPArcadeGameRegistry::Entry *type;
+    Json::Value config;
+    std::shared_ptr<FPPArcadeGameOptions> options;
+    int idx;
+    // runtime brightness override, -1 for the configured one
+    int brightness = -1;
+    std::unique_ptr<FPPArcadeGame> game;
+};
+
+class FPPArcadePlugin : public FPPPlugins::Plugin, public FPPPlugins::APIProviderPlugin, public FPPPlugins::ChannelDataPlugin {
 public:
     
-    FPPArcadePlugin() : FPPPlugins::Plugin("fpp-arcade"), FPPPlugins::APIProviderPlugin() {
+    FPPArcadePlugin() : FPPPlugins::Plugin("fpp-arcade"), FPPPlugins::APIProviderPlugin(), FPPPlugins::ChannelDataPlugin() {
         LogInfo(VB_PLUGIN, "Initializing Arcade Plugin\n");
         resetArcadeState();
+        FPPArcadeScores::INSTANCE.start();
         
-        int idx = 0;
-        if (FileExists(FPP_DIR_CONFIG("/plugin.fpp-arcade.json"))) {
-            Json::Value root;
-            if (LoadJsonFromFile(FPP_DIR_CONFIG("/plugin.fpp-arcade.json"), root)
-                && root.isMember("games")) {
-                for (int x = 0; x < root["games"].size(); x++) {
-                    if (root["games"][x]["enabled"].asBool()) {
-                        std::string model = root["games"][x]["model"].asString();
-                        games[model].push_back(createGame(root["games"][x]));
-                        if (games[model].back() != nullptr) {
-                            games[model].back()->setIdx(++idx);
-                        }
-                    }
-                }
-            }
-        }
-        
-        if (FileExists(FPP_DIR_CONFIG("/joysticks.json"))) {
-            Json::Value root;
-            if (LoadJsonFromFile(FPP_DIR_CONFIG("/joysticks.json"), root)) {
-                for (int x = 0; x < root.size(); x++) {
-                    if (root[x]["enabled"].asBool()) {
-                        std::string controller = root[x]["controller"].asString();
-                        
-                        if (root[x].isMember("button")) {
-                            int button =  root[x]["button"].asInt();
-                            std::string ev = controller + ":" + std::to_string(button);
-                            events[ev + ":1"] = root[x]["pressed"];
-                            events[ev + ":0"] = root[x]["released"];
-                        } else if (root[x].isMember("axis")) {
-                            int button =  root[x]["axis"].asInt();
-                            std::string ev = controller + ":a" + std::to_string(button);
-                            events[ev] = root[x]["command"];
-                        }
-                    }
-                }
-            }
-        }
+        loadGames();
+        loadEvents();
     }
     virtual ~FPPArcadePlugin() {
 #ifdef USE_SDL_CONTROLLERS
@@ -402,60 +1119,238 @@ public:
         // callback can't fire into freed memory.
         Timers::INSTANCE.stopPeriodicTimer("ArcadeSDLEventPump");
 #endif
+        Timers::INSTANCE.stopPeriodicTimer("ArcadeConfigWatch");
+        Timers::INSTANCE.stopPeriodicTimer("ArcadeAttract");
+        FPPArcadeScheduler::INSTANCE.shutdown();
+        stopRecorders();
+        FPPArcadeView::INSTANCE.stop();
         resetArcadeState();
+        std::lock_guard<std::mutex> lock(gamesLock);
+        stopAttract();
         for (auto & a : games) {
             for (auto &g : a.second) {
                 delete g;
             }
         }
+        // after the games so nothing can submit to a stopped writer
+        FPPArcadeScores::INSTANCE.stop();
     }
-    FPPArcadeGame *createGame(Json::Value &config) {
-        std::string game = config["game"].asString();
-        if (game == "Tetris") {
-            return new FPPTetris(config);
+
+    static time_t getModifiedTime(const std::string &file) {
+        struct stat st;
+        if (stat(file.c_str(), &st) == 0) {
+            return st.st_mtime;
         }
-        if (game == "Pong") {
-            return new FPPPong(config);
+        return 0;
+    }
+
+    // Called from a periodic timer on the main loop.  Polling the mtime is
+    // cheap and works the same on Linux and macOS.
+    void checkConfigFiles() {
+        if (getModifiedTime(FPP_DIR_CONFIG("/plugin.fpp-arcade.json")) != gamesModified) {
+            LogInfo(VB_PLUGIN, "FPP Arcade: plugin.fpp-arcade.json changed, reloading games\n");
+            loadGames();
         }
-        if (game == "Snake") {
-            return new FPPSnake(config);
+        if (getModifiedTime(FPP_DIR_CONFIG("/joysticks.json")) != eventsModified) {
+            LogInfo(VB_PLUGIN, "FPP Arcade: joysticks.json changed, reloading joystick mappings\n");
+            loadEvents();
         }
-        if (game == "Breakout") {
-            return new FPPBreakout(config);
+    }
+
+    // (Re)load plugin.fpp-arcade.json.  Slots whose config entry is unchanged
+    // are kept, including any game that is running in them.  Slots that were
+    // removed or whose config changed are stopped and deleted.
+    void loadGames() {
+        std::string file = FPP_DIR_CONFIG("/plugin.fpp-arcade.json");
+        time_t modified = getModifiedTime(file);
+        Json::Value root;
+        if (FileExists(file) && !LoadJsonFromFile(file, root)) {
+            // gamesModified is left alone so the next poll tries again, the
+            // file may have been caught half written
+            if (modified != gamesFailed) {
+                LogErr(VB_PLUGIN, "FPP Arcade: could not parse %s, keeping current games\n", file.c_str());
+                gamesFailed = modified;
+            }
+            return;
         }
-        return nullptr;
+        gamesModified = modified;
+
+        int workerThreads = root.get("workerThreads", 0).asInt();
+        if (workerThreads < 0 || workerThreads > 16) {
+            LogErr(VB_PLUGIN, "FPP Arcade: workerThreads %d is outside 0-16, using 0\n", workerThreads);
+            workerThreads = 0;
+        }
+        FPPArcadeScheduler::INSTANCE.setWorkerCount(workerThreads);
+
+        std::lock_guard<std::mutex> lock(gamesLock);
+        // demos and prepared demos point at slots that may be about to go
+        stopAttract();
+        attractIdleMS = std::clamp(root.get("attractIdle", 0).asInt(), 0, 3600) * 1000;
+        attractTimeMS = std::clamp(root.get("attractTime", 60).asInt(), 10, 3600) * 1000;
+        std::map<std::string, FPPArcadeGameSlot*> selected;
+        for (auto &a : games) {
+            if (!a.second.empty()) {
+                selected[a.first] = a.second.front();
+            }
+        }
+        std::map<std::string, std::list<FPPArcadeGameSlot*>> newGames;
+        int idx = 0;
+        int added = 0;
+        int kept = 0;
+        if (root.isMember("games")) {
+            for (int x = 0; x < root["games"].size(); x++) {
+                const Json::Value &cfg = root["games"][x];
+                if (!cfg["enabled"].asBool()) {
+                    continue;
+                }
+                std::string model = cfg["model"].asString();
+                std::string game = cfg["game"].asString();
+                const FPPArcadeGameRegistry::Entry *type = FPPArcadeGameRegistry::INSTANCE().find(game);
+                if (type == nullptr) {
+                    LogErr(VB_PLUGIN, "FPP Arcade: unknown game \"%s\" configured for model %s\n", game.c_str(), model.c_str());
+                    continue;
+                }
+                ++idx;
+                FPPArcadeGameSlot *slot = nullptr;
+                auto &old = games[model];
+                for (auto it = old.begin(); it != old.end(); ++it) {
+                    if ((*it)->config == cfg) {
+                        slot = *it;
+                        old.erase(it);
+                        break;
+                    }
+                }
+                if (slot) {
+                    slot->setIdx(idx);
+                    kept++;
+                } else {
+                    slot = new FPPArcadeGameSlot(type, cfg, idx);
+                    added++;
+                }
+                newGames[model].push_back(slot);
+            }
+        }
+
+        int removed = 0;
+        for (auto &a : games) {
+            for (auto &slot : a.second) {
+                slot->stop();
+                delete slot;
+                removed++;
+            }
+        }
+        for (auto &a : newGames) {
+            // keep whatever game was selected on the model at the front
+            auto f = selected.find(a.first);
+            if (f != selected.end()) {
+                for (int x = 0; x < a.second.size(); x++) {
+                    if (a.second.front() == f->second) {
+                        break;
+                    }
+                    a.second.push_back(a.second.front());
+                    a.second.pop_front();
+                }
+            }
+        }
+        games = std::move(newGames);
+        LogInfo(VB_PLUGIN, "FPP Arcade: %d games loaded (%d unchanged, %d added, %d removed)\n", idx, kept, added, removed);
+    }
+
+    // (Re)load joysticks.json, only touching mappings that changed.
+    void loadEvents() {
+        std::string file = FPP_DIR_CONFIG("/joysticks.json");
+        time_t modified = getModifiedTime(file);
+        Json::Value root;
+        if (FileExists(file) && !LoadJsonFromFile(file, root)) {
+            // eventsModified is left alone so the next poll tries again, the
+            // file may have been caught half written
+            if (modified != eventsFailed) {
+                LogErr(VB_PLUGIN, "FPP Arcade: could not parse %s, keeping current mappings\n", file.c_str());
+                eventsFailed = modified;
+            }
+            return;
+        }
+        eventsModified = modified;
+        std::map<std::string, Json::Value> newEvents;
+        for (int x = 0; x < root.size(); x++) {
+            if (root[x]["enabled"].asBool()) {
+                std::string controller = root[x]["controller"].asString();
+                
+                if (root[x].isMember("button")) {
+                    int button =  root[x]["button"].asInt();
+                    std::string ev = controller + ":" + std::to_string(button);
+                    newEvents[ev + ":1"] = root[x]["pressed"];
+                    newEvents[ev + ":0"] = root[x]["released"];
+                } else if (root[x].isMember("axis")) {
+                    int button =  root[x]["axis"].asInt();
+                    std::string ev = controller + ":a" + std::to_string(button);
+                    newEvents[ev] = root[x]["command"];
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(eventsLock);
+        int changed = 0;
+        for (auto it = events.begin(); it != events.end();) {
+            if (newEvents.find(it->first) == newEvents.end()) {
+                it = events.erase(it);
+                changed++;
+            } else {
+                ++it;
+            }
+        }
+        for (auto &a : newEvents) {
+            auto f = events.find(a.first);
+            if (f == events.end() || f->second != a.second) {
+                events[a.first] = a.second;
+                changed++;
+            }
+        }
+        LogInfo(VB_PLUGIN, "FPP Arcade: %d joystick mappings, %d changed\n", (int)events.size(), changed);
     }
-    
 
-    void handleButton(std::list<FPPArcadeGame *> &games, const std::string &button, const std::vector<std::string> &args) {
-        if (button == "Start - Pressed" || button == "Select - Pressed") {
-            if (games.front()->isRunning()) {
-                games.front()->stop();
+    void handleButton(const std::string &model, std::list<FPPArcadeGameSlot *> &games, const std::string &button, int player) {
+        ARCADE_TRACE("button");
+        if (noteInput(model, games)) {
+            // straight into a live game of whatever was being demoed
+            if (button.find("Released") == std::string::npos) {
+                games.front()->get()->input(button, player);
             }
+            return;
+        }
+        if (button == "Start - Pressed" && games.front()->isRunning()) {
+            games.front()->get()->togglePause();
+            return;
+        }
+        if (button == "Select - Pressed" && games.front()->isRunning()) {
+            // switching back to the game picks up where it was left
+            games.front()->get()->suspend();
         }
         if (button == "Start - Released" || button == "Select - Released") {
             return;
         }
         if (button == "Select - Pressed") {
-            FPPArcadeGame *g = games.front();
+            FPPArcadeGameSlot *g = games.front();
             games.pop_front();
             games.push_back(g);
         } else {
-            games.front()->button(button);
+            games.front()->get()->input(button, player);
         }
     }
     std::unique_ptr<Command::Result>  selectGame(const std::vector<std::string> &args) {
         int idx = std::atoi(args[0].c_str());
         const std::string model = args.size() > 1 ? args[1] : "";
+        std::lock_guard<std::mutex> lock(gamesLock);
         int max = games[model].size();
         if (max == 0) {
             return std::make_unique<Command::ErrorResult>("FPP Arcade No games configured for model " + model);
         }
+        noteInput(model, games[model]);
         if (games[model].front()->isRunning()) {
-            games[model].front()->stop();
+            games[model].front()->get()->suspend();
         }
         for (int x = 0; x < max; x++) {
-            FPPArcadeGame *g = games[model].front();
+            FPPArcadeGameSlot *g = games[model].front();
             if (g->getIdx() == idx) {
                 return std::make_unique<Command::Result>("FPP Arcade Game " + g->getName() + " Selected");
             } else {
@@ -465,19 +1360,89 @@ public:
         }
         return std::make_unique<Command::ErrorResult>("FPP Arcade Could not find game matching " + args[0] + " for model " + model);
     }
+    std::unique_ptr<Command::Result> pause(const std::vector<std::string> &args) {
+        const std::string action = args[0];
+        const std::string model = args.size() > 1 ? args[1] : "";
+        std::lock_guard<std::mutex> lock(gamesLock);
+        int count = 0;
+        for (auto &a : games) {
+            if (a.second.empty() || (model != "" && a.first != model)) {
+                continue;
+            }
+            FPPArcadeGameSlot *slot = a.second.front();
+            if (action == "Resume") {
+                noteInput(a.first, a.second);
+                if (!a.second.front()->isRunning()) {
+                    // bring the game that was put aside back to the front
+                    for (int x = 0; x < a.second.size(); x++) {
+                        if (a.second.front()->game && a.second.front()->game->hasSnapshot()) {
+                            break;
+                        }
+                        a.second.push_back(a.second.front());
+                        a.second.pop_front();
+                    }
+                }
+                count += a.second.front()->get()->resume() ? 1 : 0;
+            } else if (action == "Suspend") {
+                if (slot->isRunning()) {
+                    slot->get()->suspend();
+                    count++;
+                }
+            } else if (action == "Discard") {
+                for (auto g : a.second) {
+                    if (g->game) {
+                        g->game->discardSnapshot();
+                    }
+                }
+                if (slot->isRunning()) {
+                    slot->stop();
+                }
+                count++;
+            } else if (slot->isRunning()) {
+                if (action == "Pause") {
+                    slot->get()->setPaused(true);
+                } else {
+                    slot->get()->togglePause();
+                }
+                count++;
+            }
+        }
+        if (count == 0) {
+            return std::make_unique<Command::ErrorResult>("FPP Arcade No game to " + action + " on " + (model == "" ? "any model" : model));
+        }
+        return std::make_unique<Command::Result>("FPP Arcade " + action + " Done");
+    }
+    std::unique_ptr<Command::Result> setBrightness(const std::vector<std::string> &args) {
+        int b = std::clamp(std::atoi(args[0].c_str()), 0, 100);
+        const std::string model = args.size() > 1 ? args[1] : "";
+        std::lock_guard<std::mutex> lock(gamesLock);
+        for (auto &a : games) {
+            if (model == "" || a.first == model) {
+                for (auto &g : a.second) {
+                    g->setBrightness(b);
+                }
+            }
+        }
+        return std::make_unique<Command::Result>("FPP Arcade Brightness Set");
+    }
     virtual std::unique_ptr<Command::Result> runAxisCommand(const std::vector<std::string> &args) {
         const std::string axis = args[0];
         const std::string model = args.size() > 1 ? args[1] : "";
         int value = args.size() > 2 ? std::atoi(args[2].c_str()) : 0;
+        int player = args.size() > 3 ? std::clamp(std::atoi(args[3].c_str()), 0, FPPArcadeGame::MAX_PLAYERS) : 0;
+        ARCADE_TRACE("axis");
+        std::lock_guard<std::mutex> lock(gamesLock);
 
         if (model != "") {
             if (!games[model].empty()) {
-                games[model].front()->axis(axis, value);
+                noteInput(model, games[model]);
+                games[model].front()->get()->axis(axis, value, player);
             }
         } else {
             for (auto &a : games) {
                 if (!a.second.empty()) {
-                    a.second.front()->axis(axis, value);
+                    noteInput(a.first, a.second);
+                    a.second.front()->get()->axis(axis, value, player);
                 }
             }
         }
@@ -486,20 +1451,92 @@ public:
     virtual std::unique_ptr<Command::Result> runCommand(const std::vector<std::string> &args) {
         const std::string button = args[0];
         const std::string model = args.size() > 1 ? args[1] : "";
+        int player = args.size() > 2 ? std::clamp(std::atoi(args[2].c_str()), 0, FPPArcadeGame::MAX_PLAYERS) : 0;
+        std::lock_guard<std::mutex> lock(gamesLock);
         if (model != "") {
             if (!games[model].empty()) {
-                handleButton(games[model], button, args);
+                handleButton(model, games[model], button, player);
             }
         } else {
             for (auto &a : games) {
                 if (!a.second.empty()) {
-                    handleButton(a.second, button, args);
+                    handleButton(a.first, a.second, button, player);
                 }
             }
         }
         return std::make_unique<Command::Result>("FPP Arcade Button Processed");
     }
     
+    // draw the lit pixels of transparent games over the sequence data, then
+    // hand the finished frame to any recorders
+    virtual void modifyChannelData(int ms, uint8_t *seqData) override {
+        FPPArcadeCanvas::compositeSparse(seqData);
+        std::lock_guard<std::mutex> lock(recordersLock);
+        for (auto &r : recorders) {
+            r.second->capture(seqData);
+        }
+    }
+
+    std::unique_ptr<Command::Result> record(const std::vector<std::string> &args) {
+        const std::string action = args[0];
+        const std::string model = args.size() > 1 ? args[1] : "";
+        std::unique_ptr<FPPArcadeRecorder> old;
+        {
+            std::lock_guard<std::mutex> lock(recordersLock);
+            auto it = recorders.find(model);
+            if (it != recorders.end()) {
+                old = std::move(it->second);
+                recorders.erase(it);
+            }
+        }
+        if (old) {
+            // finalizing can take a moment, don't hold up the output thread
+            old->stop();
+        }
+        if (action == "Stop") {
+            if (!old) {
+                return std::make_unique<Command::ErrorResult>("FPP Arcade Not recording " + model);
+            }
+            return std::make_unique<Command::Result>("FPP Arcade Recorded " + std::to_string(old->getFramesWritten()) + " frames to " + old->getFilename());
+        }
+
+        PixelOverlayModel *m = PixelOverlayManager::INSTANCE.getModel(model);
+        if (m == nullptr) {
+            return std::make_unique<Command::ErrorResult>("FPP Arcade No model " + model);
+        }
+        std::string name = args.size() > 2 ? args[2] : "";
+        if (name.empty()) {
+            char buf[32];
+            time_t t = time(nullptr);
+            strftime(buf, sizeof(buf), "%Y%m%d-%H%M%S", localtime(&t));
+            name = "Arcade-" + model + "-" + buf;
+        }
+        if (name.size() < 5 || name.substr(name.size() - 5) != ".fseq") {
+            name += ".fseq";
+        }
+        int step = args.size() > 3 ? std::clamp(std::atoi(args[3].c_str()), 10, 100) : 25;
+        int maxMinutes = args.size() > 4 ? std::clamp(std::atoi(args[4].c_str()), 1, 120) : 10;
+        std::unique_ptr<FPPArcadeRecorder> r = std::make_unique<FPPArcadeRecorder>(FPP_DIR_SEQUENCE("/" + name),
+            m->getStartChannel(), m->getChannelCount(), step, maxMinutes);
+        if (!r->start()) {
+            return std::make_unique<Command::ErrorResult>("FPP Arcade Could not create " + name);
+        }
+        LogInfo(VB_PLUGIN, "FPP Arcade: recording %s to %s\n", model.c_str(), name.c_str());
+        std::lock_guard<std::mutex> lock(recordersLock);
+        recorders[model] = std::move(r);
+        return std::make_unique<Command::Result>("FPP Arcade Recording " + model + " to " + name);
+    }
+    void stopRecorders() {
+        std::map<std::string, std::unique_ptr<FPPArcadeRecorder>> r;
+        {
+            std::lock_guard<std::mutex> lock(recordersLock);
+            r.swap(recorders);
+        }
+        for (auto &a : r) {
+            a.second->stop();
+        }
+    }
+
     void registerApis() override {
         LogInfo(VB_PLUGIN, "Registering Arcade Plugin APIs\n");
         auto handleArcade = [](const HttpRequestPtr& req,
@@ -529,11 +1566,44 @@ public:
                     v += a + "\n";
                 }
                 callback(makeStringResponse(v, 200));
+            } else if (path == "trace") {
+                int seconds = 5;
+                if (!req->getParameter("seconds").empty()) {
+                    seconds = std::atoi(req->getParameter("seconds").c_str());
+                }
+                seconds = std::clamp(seconds, 1, 60);
+                if (!FPPArcadeTrace::start()) {
+                    callback(makeStringResponse("Trace already in progress", 409));
+                    return;
+                }
+                drogon::app().getLoop()->runAfter(seconds, [callback = std::move(callback)]() {
+                    FPPArcadeTrace::stop();
+                    callback(makeStringResponse(FPPArcadeTrace::toChromeJSON(), 200, "application/json"));
+                });
+            } else if (path == "scores") {
+                std::string json;
+                std::string etag;
+                FPPArcadeScores::INSTANCE.getJSON(json, etag);
+                if (req->getHeader("If-None-Match") == etag) {
+                    auto resp = makeStringResponse("", 304);
+                    resp->addHeader("ETag", etag);
+                    callback(resp);
+                    return;
+                }
+                auto resp = makeStringResponse(json, 200, "application/json");
+                resp->addHeader("ETag", etag);
+                resp->addHeader("Cache-Control", "no-cache");
+                callback(resp);
+            } else if (path == "metrics") {
+                callback(makeStringResponse(FPPArcadeMetrics::INSTANCE.toPrometheus(), 200, "text/plain; version=0.0.4"));
             } else {
                 callback(makeStringResponse("Not found", 404));
             }
         };
         auto handleArcade2 = handleArcade;
+        auto handleArcade3 = handleArcade;
+        auto handleArcade4 = handleArcade;
+        auto handleArcade5 = handleArcade;
 
         // Only the plain paths are needed: Apache rewrites
         // api/plugin-apis/arcade/* to localhost:32322/arcade/*, stripping the
@@ -541,6 +1611,11 @@ public:
         // never be reached.
         drogon::app().registerHandler("/arcade/controllers", std::move(handleArcade), {drogon::Get});
         drogon::app().registerHandler("/arcade/events", std::move(handleArcade2), {drogon::Get});
+        drogon::app().registerHandler("/arcade/metrics", std::move(handleArcade3), {drogon::Get});
+        drogon::app().registerHandler("/arcade/trace", std::move(handleArcade4), {drogon::Get});
+        drogon::app().registerHandler("/arcade/scores", std::move(handleArcade5), {drogon::Get});
+        // WebSocket /arcade/view/<model>
+        FPPArcadeView::INSTANCE.start();
     }
 
 #ifdef USE_SDL_CONTROLLERS
@@ -549,20 +1624,26 @@ public:
         return p->handleSDLControllerEvent(event);
     }
     int handleSDLControllerEvent(SDL_Event * event) {
+        ARCADE_TRACE("controller event");
         switch (event->type) {
             case SDL_CONTROLLERAXISMOTION: {
                 SDL_ControllerAxisEvent *ae = (SDL_ControllerAxisEvent*)event;
                 std::string joystickName;
+                FPPArcadeControllerMetrics *metrics = nullptr;
                 {
                     std::lock_guard<std::mutex> lock(joysticksLock);
                     for (const auto &j : joysticks) {
                         if (j.joystickId == ae->which) {
                             joystickName = j.name;
+                            metrics = j.metrics;
                             break;
                         }
                     }
                 }
                 if (!joystickName.empty()) {
+                    if (metrics) {
+                        metrics->events.inc();
+                    }
                     std::string s = joystickName;
                     s += " - ";
                     s += "axis: " + std::to_string(ae->axis);
@@ -577,16 +1658,21 @@ public:
             case SDL_CONTROLLERBUTTONUP: {
                 SDL_ControllerButtonEvent *be = (SDL_ControllerButtonEvent*)event;
                 std::string joystickName;
+                FPPArcadeControllerMetrics *metrics = nullptr;
                 {
                     std::lock_guard<std::mutex> lock(joysticksLock);
                     for (const auto &j : joysticks) {
                         if (j.joystickId == be->which) {
                             joystickName = j.name;
+                            metrics = j.metrics;
                             break;
                         }
                     }
                 }
                 if (!joystickName.empty()) {
+                    if (metrics) {
+                        metrics->events.inc();
+                    }
                     std::string s = joystickName;
                     s += " - ";
                     s += "button: " + std::to_string(be->button);
@@ -626,12 +1712,25 @@ public:
             if (names[j.name] != 1) {
                 j.name = j.name + " - " + std::to_string(names[j.name]);
             }
+            j.metrics = FPPArcadeMetrics::INSTANCE.getControllerMetrics(j.name);
         }
     }
     virtual void addControlCallbacks(std::map<int, std::function<bool(int)>> &callbacks) override {
         CommandManager::INSTANCE.addCommand(new FPPArcadeCommand(this));
         CommandManager::INSTANCE.addCommand(new FPPArcadeAxisCommand(this));
         CommandManager::INSTANCE.addCommand(new FPPArcadeSelectGameCommand(this));
+        CommandManager::INSTANCE.addCommand(new FPPArcadeBrightnessCommand(this));
+        CommandManager::INSTANCE.addCommand(new FPPArcadePauseCommand(this));
+        CommandManager::INSTANCE.addCommand(new FPPArcadeRecordCommand(this));
+
+        // pick up edits from plugin_setup.php and joysticks.php without
+        // restarting fppd
+        Timers::INSTANCE.addPeriodicTimer("ArcadeConfigWatch", 2000, [this]() {
+            checkConfigFiles();
+        });
+        Timers::INSTANCE.addPeriodicTimer("ArcadeAttract", 250, [this]() {
+            checkAttract();
+        });
 
 #ifdef USE_SDL_CONTROLLERS
         SDL_Init(SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER | SDL_INIT_EVENTS);
@@ -675,19 +1774,21 @@ public:
         }
         checkUniqueNames();
 
-        std::vector<std::pair<int, std::string>> joystickSnapshot;
+        std::vector<std::tuple<int, std::string, FPPArcadeControllerMetrics*>> joystickSnapshot;
         {
             std::lock_guard<std::mutex> lock(joysticksLock);
             joystickSnapshot.reserve(joysticks.size());
             for (const auto &a : joysticks) {
-                joystickSnapshot.emplace_back(a.file, a.name);
+                joystickSnapshot.emplace_back(a.file, a.name, a.metrics);
             }
         }
         for (const auto &a : joystickSnapshot) {
-            callbacks[a.first] = [joyName = a.second, this] (int f) {
+            callbacks[std::get<0>(a)] = [joyName = std::get<1>(a), metrics = std::get<2>(a), this] (int f) {
+                ARCADE_TRACE("joystick read");
                 struct js_event ev;
                 while (read(f, &ev, sizeof(ev)) > 0) {
                     if (!(ev.type & JS_EVENT_INIT)) {
+                        metrics->events.inc();
                         std::string s = joyName;
                         s += " - ";
                         if (ev.type == 1) {
@@ -713,21 +1814,168 @@ public:
     }
     
     void processEvent(const std::string &ev, int value) {
-        const auto &f = events.find(ev);
-        if (f != events.end()) {
-            if (f->second["command"] != "") {
-                if (f->second["command"] == "FPP Arcade Axis") {
-                    Json::Value val = f->second;
-                    val["args"][2] = std::to_string(value);
-                    CommandManager::INSTANCE.run(val);
-                } else {
-                    CommandManager::INSTANCE.run(f->second);
-                }
+        ARCADE_TRACE("dispatch command");
+        Json::Value val;
+        {
+            // copy out so a reload can't change the mapping under the command
+            std::lock_guard<std::mutex> lock(eventsLock);
+            const auto &f = events.find(ev);
+            if (f == events.end()) {
+                return;
             }
+            val = f->second;
+        }
+        if (val["command"] != "") {
+            if (val["command"] == "FPP Arcade Axis") {
+                val["args"][2] = std::to_string(value);
+            }
+            CommandManager::INSTANCE.run(val);
         }
     }
     
-    std::map<std::string, std::list<FPPArcadeGame*>> games;
+    // Attract mode: after attractIdleMS without input on a model, its games
+    // that have a demo take turns playing themselves, attractTimeMS each.
+    // The next demo is built ATTRACT_PREPARE_MS before it is due so the
+    // switch is just swapping effects.  Everything here is under gamesLock.
+    class AttractState {
+    public:
+        uint64_t lastInput = 0;
+        // slot whose demo is showing, nullptr while idle or in live play
+        FPPArcadeGameSlot *demo = nullptr;
+        uint64_t demoEnds = 0;
+        FPPArcadeGameSlot *nextSlot = nullptr;
+        FPPArcadeGameEffect *prepared = nullptr;
+    };
+    static constexpr uint64_t ATTRACT_PREPARE_MS = 3000;
+
+    void discardPrepared(AttractState &st) {
+        // never started, so deleting it doesn't touch the models
+        delete st.prepared;
+        st.prepared = nullptr;
+        st.nextSlot = nullptr;
+    }
+
+    void stopAttract() {
+        for (auto &a : attract) {
+            discardPrepared(a.second);
+            if (a.second.demo) {
+                a.second.demo->stop();
+            }
+        }
+        attract.clear();
+    }
+
+    // build the demo of the next game after the current one that has one
+    void prepareNextDemo(std::list<FPPArcadeGameSlot*> &slots, AttractState &st) {
+        std::vector<FPPArcadeGameSlot*> v(slots.begin(), slots.end());
+        int n = v.size();
+        int start = -1;
+        for (int x = 0; x < n; x++) {
+            if (v[x] == st.demo) {
+                start = x;
+            }
+        }
+        for (int x = 1; x <= n; x++) {
+            FPPArcadeGameSlot *slot = v[(start + x) % n];
+            FPPArcadeGameEffect *e = slot->get()->prepareDemo();
+            if (e) {
+                st.prepared = e;
+                st.nextSlot = slot;
+                return;
+            }
+        }
+    }
+
+    void switchDemo(const std::string &model, std::list<FPPArcadeGameSlot*> &slots, AttractState &st, uint64_t now) {
+        if (st.prepared == nullptr) {
+            prepareNextDemo(slots, st);
+        }
+        if (st.demo) {
+            // deletes the running demo, its model is taken over below
+            st.demo->stop();
+            st.demo = nullptr;
+        }
+        if (st.prepared == nullptr) {
+            return;
+        }
+        st.demo = st.nextSlot;
+        FPPArcadeGameEffect *e = st.prepared;
+        st.prepared = nullptr;
+        st.nextSlot = nullptr;
+        st.demo->get()->startDemo(e);
+        st.demoEnds = now + attractTimeMS;
+        LogDebug(VB_PLUGIN, "FPP Arcade: attract mode on %s showing %s\n", model.c_str(), st.demo->getName().c_str());
+    }
+
+    // called from a periodic timer on the main loop
+    void checkAttract() {
+        if (attractIdleMS <= 0) {
+            return;
+        }
+        uint64_t now = GetTimeMS();
+        std::lock_guard<std::mutex> lock(gamesLock);
+        for (auto &a : games) {
+            if (a.second.empty()) {
+                continue;
+            }
+            AttractState &st = attract[a.first];
+            if (st.demo == nullptr) {
+                // a paused game left alone long enough is suspended by the
+                // demo taking over its model, input brings it back
+                bool live = false;
+                for (auto g : a.second) {
+                    live |= g->isRunning() && !g->isPaused();
+                }
+                // the idle time counts from the end of the last live game
+                if (live || st.lastInput == 0) {
+                    st.lastInput = now;
+                } else if (now - st.lastInput >= attractIdleMS) {
+                    switchDemo(a.first, a.second, st, now);
+                    if (st.demo == nullptr) {
+                        // nothing on this model has a demo, check again later
+                        st.lastInput = now;
+                    }
+                }
+            } else if (!st.demo->isRunning() || now >= st.demoEnds) {
+                switchDemo(a.first, a.second, st, now);
+            } else if (st.prepared == nullptr && now + ATTRACT_PREPARE_MS >= st.demoEnds) {
+                prepareNextDemo(a.second, st);
+            }
+        }
+    }
+
+    // Resets the model's idle time.  If a demo is showing it is stopped and
+    // its game moved to the front so the input starts a live game of it,
+    // returns true in that case.
+    bool noteInput(const std::string &model, std::list<FPPArcadeGameSlot*> &slots) {
+        auto f = attract.find(model);
+        if (f == attract.end()) {
+            return false;
+        }
+        AttractState &st = f->second;
+        st.lastInput = GetTimeMS();
+        if (st.demo == nullptr) {
+            return false;
+        }
+        discardPrepared(st);
+        FPPArcadeGameSlot *d = st.demo;
+        st.demo = nullptr;
+        d->stop();
+        for (int x = 0; x < slots.size() && slots.front() != d; x++) {
+            slots.push_back(slots.front());
+            slots.pop_front();
+        }
+        return true;
+    }
+
+    std::mutex gamesLock;
+    std::map<std::string, std::list<FPPArcadeGameSlot*>> games;
+    time_t gamesModified = 0;
+    // mtime of the last version that didn't parse, so it is only logged once
+    time_t gamesFailed = 0;
+    std::map<std::string, AttractState> attract;
+    int attractIdleMS = 0;
+    int attractTimeMS = 60000;
     
     class Joystick {
     public:
@@ -767,7 +2015,7 @@ public:
             }
 #endif
         }
-        Joystick(Joystick &&j) : file(j.file), name(j.name), numButtons(j.numButtons), numAxis(j.numAxis), controller(j.controller), joystickId(j.joystickId) {
+        Joystick(Joystick &&j) : file(j.file), name(j.name), numButtons(j.numButtons), numAxis(j.numAxis), controller(j.controller), joystickId(j.joystickId), metrics(j.metrics) {
             j.file = -1;
             j.controller = nullptr;
         }
@@ -792,23 +2040,43 @@ public:
         int numButtons = 0;
         int numAxis = 0;
         int file;
+        FPPArcadeControllerMetrics *metrics = nullptr;
     };
     
     std::list<Joystick> joysticks;
     std::mutex joysticksLock;
+    std::mutex eventsLock;
     std::map<std::string, Json::Value> events;
+    time_t eventsModified = 0;
+    time_t eventsFailed = 0;
+
+    // by model name, captured from modifyChannelData()
+    std::mutex recordersLock;
+    std::map<std::string, std::unique_ptr<FPPArcadeRecorder>> recorders;
 };
 
 
 std::unique_ptr<Command::Result> FPPArcadeCommand::run(const std::vector<std::string> &args) {
+    FPPArcadeMetrics::INSTANCE.buttonCommands.inc();
     return plugin->runCommand(args);
 }
 std::unique_ptr<Command::Result> FPPArcadeAxisCommand::run(const std::vector<std::string> &args) {
+    FPPArcadeMetrics::INSTANCE.axisCommands.inc();
     return plugin->runAxisCommand(args);
 }
 std::unique_ptr<Command::Result> FPPArcadeSelectGameCommand::run(const std::vector<std::string> &args) {
+    FPPArcadeMetrics::INSTANCE.selectCommands.inc();
     return plugin->selectGame(args);
 }
+std::unique_ptr<Command::Result> FPPArcadeBrightnessCommand::run(const std::vector<std::string> &args) {
+    return plugin->setBrightness(args);
+}
+std::unique_ptr<Command::Result> FPPArcadePauseCommand::run(const std::vector<std::string> &args) {
+    return plugin->pause(args);
+}
+std::unique_ptr<Command::Result> FPPArcadeRecordCommand::run(const std::vector<std::string> &args) {
+    return plugin->record(args);
+}
 
 extern "C" {
     FPPPlugins::Plugin *createPlugin() {
@@ -1,49 +1,337 @@
 #ifndef __FPPARCADE__
 #define __FPPARCADE__
 
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "overlays/PixelOverlayEffects.h"
 
+#include "FPPArcadeCanvas.h"
+#include "FPPArcadeParticles.h"
+
+class FPPArcadeGameMetrics;
+class FPPArcadeGameEffect;
+class FPPArcadeNetplayOptions;
+class FPPArcadeSnapshot;
+class PixelOverlayModel;
+
+// Typed, validated view of a game's entry in plugin.fpp-arcade.json.  Each
+// game subclasses this with its own fields and registers it as the game's
+// options schema (see FPPArcadeGameRegistration).  It is parsed when the
+// config is loaded, so starting a game never has to go back to the Json.
+// Bad values are logged and replaced by the default.
+class FPPArcadeGameOptions {
+public:
+    FPPArcadeGameOptions(const Json::Value &config);
+    virtual ~FPPArcadeGameOptions() {}
+
+    std::string model;
+    std::string game;
+    bool transparent = false;
+
+    // extra models the game surface is laid out across, after "model"
+    std::vector<std::string> spanModels;
+    FPPArcadeCanvas::Layout spanLayout = FPPArcadeCanvas::Layout::Horizontal;
+    int spanColumns = 1;
+    // rotation/mirroring/offset of the picture on the models
+    FPPArcadeCanvas::Transform transform;
+    int brightness = 100;
+    float gamma = 1.0f;
+    std::string colorOrder = "RGB";
+    // ask for initials when a score makes the high score table
+    bool initials = false;
+
+protected:
+    static std::string findOption(const Json::Value &config, const std::string &s, const std::string &def = "");
+    int intOption(const Json::Value &config, const std::string &s, int def, int min, int max) const;
+    float floatOption(const Json::Value &config, const std::string &s, float def, float min, float max) const;
+    std::string choiceOption(const Json::Value &config, const std::string &s, const std::vector<std::string> &choices) const;
+    // the "Net ..." options, for games that support FPPArcadeNetplay
+    void netplayOptions(const Json::Value &config, FPPArcadeNetplayOptions &n) const;
+};
+
 class FPPArcadeGame {
 public:
-    FPPArcadeGame(Json::Value &config);
-    virtual ~FPPArcadeGame() {}
+    FPPArcadeGame(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options);
+    virtual ~FPPArcadeGame();
     
     virtual const std::string &getName() = 0;
     
+    // commands and controllers can name a player, 1 to MAX_PLAYERS, so
+    // several joysticks can drive one game.  0 is "not bound to a player".
+    static constexpr int MAX_PLAYERS = 8;
+
     virtual void button(const std::string &button) {}
-    virtual void axis(const std::string &axis, int value);
+    // games with more than one controller override this, the default
+    // ignores the player
+    virtual void playerButton(int player, const std::string &button) { this->button(button); }
+    virtual void axis(const std::string &axis, int value, int player = 0);
+    // Entry point for button events from commands and controllers.  Turns
+    // directions on the (possibly rotated or mirrored) display into the
+    // game's own directions and passes them to playerButton().
+    void input(const std::string &button, int player = 0);
 
     
     virtual bool isRunning();
+    // ends the session for good
     virtual void stop();
 
+    // Pausing and resuming.  A paused session keeps its model but stops
+    // moving and ignores input until it is resumed.  suspend() snapshots
+    // the session and then stops it, the next session started, by any
+    // button or resume(), carries on from the snapshot instead of being a
+    // new game.  A session that ends because something else took over the
+    // model is kept the same way.
+    bool isPaused();
+    void setPaused(bool p);
+    void togglePause();
+    void suspend();
+    // unpauses the running session or restores the suspended one, false
+    // if there is neither
+    bool resume();
+    bool hasSnapshot();
+    void discardSnapshot();
+    // called from FPPArcadeGameEffect::saveSession()
+    void keepSnapshot(std::vector<uint8_t> &&s);
+
+    // runtime override of the "Brightness" option, applies to the running
+    // effect immediately and to later sessions
+    void setBrightness(int b);
+
     int getIdx() const { return idx; };
     void setIdx(int i) { idx = i; }
+
+    // Drop the cached model, called by FPP when the overlay models are
+    // reloaded.  The next session resolves the model by name again.
+    void invalidate();
+    // called from ~FPPArcadeGameEffect
+    void effectEnded(FPPArcadeGameEffect *e);
+
+    // Attract mode.  prepareDemo() builds a whole demo session, canvas,
+    // palette and game state, without touching the models, so it can be
+    // done while the previous demo is still showing.  startDemo() then only
+    // has to hand it to the model.  nullptr if the game has no demo.
+    FPPArcadeGameEffect *prepareDemo();
+    void startDemo(FPPArcadeGameEffect *e);
 protected:
-    std::string findOption(const std::string &s, const std::string &def = "");
-    
+    // the game playing itself on c, for games that have a demo mode
+    virtual FPPArcadeGameEffect *createDemo(FPPArcadeCanvas *c) { return nullptr; }
+
+    // Enabled for "Overwrite" games.  "Transparent" games leave the model
+    // disabled and are composited from the canvas' sparse spans instead.
+    void setOverlayState(PixelOverlayModel *m);
+
+    // The effect this game started and that is still running on the model.
+    // Subclasses static_cast this to their own effect type; it is only ever
+    // set to an effect they created so no RTTI is needed on the input path.
+    FPPArcadeGameEffect *getEffect() const { return effect.load(std::memory_order_acquire); }
+    // resolves the model by name, only needed when starting a new session
+    PixelOverlayModel *resolveModel();
+    // canvas over m and any "Span Models", with their overlay state set
+    FPPArcadeCanvas *createCanvas(PixelOverlayModel *m);
+    // the same split in two, building the canvas leaves the models alone
+    FPPArcadeCanvas *buildCanvas(PixelOverlayModel *m);
+    FPPArcadeCanvas *createSpanCanvas(PixelOverlayModel *m);
+    void activateCanvas(FPPArcadeCanvas *c);
+    // link a newly created effect to this game and start it on the model
+    void startEffect(FPPArcadeGameEffect *e, int32_t firstUpdateMS = 50);
+
     std::string modelName;    
     Json::Value config;
-    int lastValues[2];
+    std::shared_ptr<FPPArcadeGameOptions> options;
+    // per player, the last up/down and left/right axis values
+    int lastValues[MAX_PLAYERS + 1][2];
     int idx;
+    std::atomic<int> brightness{-1};
+private:
+    std::atomic<FPPArcadeGameEffect*> effect{nullptr};
+    std::atomic<PixelOverlayModel*> model{nullptr};
+    // our id with PixelOverlayManager's model listeners
+    std::string listenerId;
+
+    std::mutex snapshotLock;
+    std::vector<uint8_t> snapshot;
 };
 
 
+// Game types register themselves here from a static initializer in their own
+// .cpp so the plugin doesn't need to know the list of games.
+class FPPArcadeGameRegistry {
+public:
+    typedef std::function<FPPArcadeGameOptions*(const Json::Value &config)> OptionsParser;
+    typedef std::function<FPPArcadeGame*(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options)> Factory;
+
+    class Entry {
+    public:
+        std::string name;
+        OptionsParser parseOptions;
+        Factory create;
+    };
+
+    static FPPArcadeGameRegistry &INSTANCE();
+
+    void add(const std::string &name, const OptionsParser &parser, const Factory &factory);
+    const Entry *find(const std::string &name) const;
+    const std::list<Entry> &getGames() const { return games; }
+private:
+    std::list<Entry> games;
+};
+
+template<class GAME, class OPTIONS>
+class FPPArcadeGameRegistration {
+public:
+    FPPArcadeGameRegistration(const std::string &name) {
+        FPPArcadeGameRegistry::INSTANCE().add(name,
+            [](const Json::Value &config) { return new OPTIONS(config); },
+            [](Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options) { return new GAME(config, options); });
+    }
+};
+
+
+// Base for the games' running effects.  Subclasses that can be driven by
+// FPPArcadeScheduler must call detachFromScheduler() first thing in their
+// destructor so a frame in progress can't tick a half destroyed object,
+// then saveSession() while their state is still intact.
 class FPPArcadeGameEffect : public RunningEffect {
 public:
-    FPPArcadeGameEffect(PixelOverlayModel *m);
+    // takes ownership of the canvas, its primary model runs the effect
+    FPPArcadeGameEffect(FPPArcadeCanvas *c);
     virtual ~FPPArcadeGameEffect();
-    
+
+    // Called by FPP.  While the effect is on the arcade scheduler this only
+    // polls for the game finishing, otherwise it runs tick() directly.
+    virtual int32_t update() override final;
+    // same contract as RunningEffect::update()
+    virtual int32_t updateGame() = 0;
+
+    // runs updateGame(), timing it and the tick interval for /arcade/metrics
+    int32_t tick();
+
+    // copy the canvas to its models and flush them; during a scheduler frame
+    // the flush is deferred and done with all the other presents at the end
+    void present();
+    void flushPresent();
+
+    // hand the effect to FPPArcadeScheduler, if it is enabled
+    void schedule(int32_t firstUpdateMS);
+    void detachFromScheduler();
+    // scheduler is done with the effect, pass the final result back to FPP
+    void finishScheduled(int32_t result);
+
+    int getWidth() const { return canvas->getWidth(); }
+    int getHeight() const { return canvas->getHeight(); }
+    void getSize(int &w, int &h) const { w = canvas->getWidth(); h = canvas->getHeight(); }
+    void clear() { canvas->clear(); }
+    uint8_t color(int r, int g, int b) { return canvas->color(r, g, b); }
+    void setPixel(int x, int y, uint8_t c) { canvas->setPixel(x, y, c); }
+    void setPixel(int x, int y, int r, int g, int b) { canvas->setPixel(x, y, r, g, b); }
+    void setBrightness(int b);
+    // turn off every model the canvas covers
+    void disable();
 
     void outputString(const std::string &s, int x, int y, int r = 255, int g = 255, int b = 255, int scl = -1);
     void outputLetter(int x, int y, char letter, int r = 255, int g = 255, int b = 255, int scl = -1);
     void outputPixel(int x, int y, int r, int g, int b, int scl = -1);
+    void outputPixel(int x, int y, uint8_t c, int scl = -1);
+
+    // A burst of particles from the middle of game cell x,y (the same
+    // coordinates as outputPixel()).  speed is in cells a second.  While
+    // any are alive tick() runs at least every PARTICLE_FRAME_MS, moving
+    // them between game frames.
+    void burst(int x, int y, int count, int r, int g, int b, float speed = 8, int lifeMS = 600);
+    // same, in palette index c
+    void burstIndex(int x, int y, int count, uint8_t c, float speed = 8, int lifeMS = 600);
     
     int scale;
     int offsetX;
     int offsetY;
+
+    // game that started this effect, cleared if the game goes away first
+    std::atomic<FPPArcadeGame*> owner{nullptr};
+    // set once the effect has been given to its model, a prepared demo
+    // that is thrown away never was
+    bool started = false;
+    // running as an attract mode demo
+    bool demo = false;
+
+    FPPArcadeCanvas *getCanvas() const { return canvas.get(); }
+
+    // High scores.  Games call gameOver() once with the final score, it is
+    // recorded in FPPArcadeScores straight away unless the game asks for
+    // initials and the score makes the table.  Then gameOver() returns
+    // true and, while enteringInitials(), updateGame() should return
+    // updateInitials() and button() hand its buttons to initialsButton().
+    bool gameOver(int score);
+    bool enteringInitials() const { return initialsActive; }
+    int32_t updateInitials();
+    bool initialsButton(const std::string &button);
+    bool askInitials = false;
+
+    // While paused tick() doesn't run the game and the picture is dimmed.
+    void setPaused(bool p);
+    bool isPaused() const { return paused; }
+    // The whole session, game state, picture and palette, as a binary
+    // image.  restore() loads one into a freshly constructed effect of the
+    // same game on a canvas of the same size.  Both are plain copies so a
+    // restore takes well under a frame.  false if the game can't be
+    // resumed (it's over) or the image doesn't fit this effect, which is
+    // then left as it was.
+    bool snapshot(std::vector<uint8_t> &out);
+    bool restore(const std::vector<uint8_t> &in);
+    // hash of the game state alone, without the picture
+    uint32_t stateHash();
+    // networked sessions can't stop without stopping the other node too
+    virtual bool canPause() const { return true; }
+    // cleared by FPPArcadeGame::stop() so the session isn't kept
+    std::atomic<bool> keepSession{true};
+
+protected:
+    // Games that can be resumed override this and pass all of their state
+    // through s.io().  Returning false, the default, means there is
+    // nothing worth resuming.
+    virtual bool serialize(FPPArcadeSnapshot &s) { return false; }
+    // Hands a snapshot of a live session to the owning game, unless it
+    // was stopped on purpose, finished or is a demo.  Called from the
+    // subclass destructor, after detachFromScheduler().
+    void saveSession();
+    // false unless the image's header matches this effect
+    bool readHeader(FPPArcadeSnapshot &s);
+
+    std::unique_ptr<FPPArcadeCanvas> canvas;
+    FPPArcadeParticles particles;
+
+private:
+    FPPArcadeGameMetrics *metrics = nullptr;
+    uint64_t lastTick = 0;
+    int32_t lastRequested = 0;
+    // when updateGame() asked to run next, 0 for straight away
+    uint64_t nextGameMS = 0;
+    uint64_t lastParticleMS = 0;
+    // the next tick is only for the particles
+    bool particleTick = false;
+
+    std::atomic<bool> scheduled{false};
+    std::atomic<bool> onScheduler{false};
+    std::atomic<bool> hasScheduledResult{false};
+    int32_t scheduledResult = 0;
+    std::atomic<bool> presentPending{false};
+
+    std::atomic<bool> paused{false};
+    std::atomic<bool> finished{false};
+    std::mutex pauseLock;
+    int pausedBrightness = 100;
+
+    std::mutex initialsLock;
+    std::atomic<bool> initialsActive{false};
+    int initialsScore = 0;
+    std::string initials;
+    int initialsPos = 0;
+    uint64_t initialsDeadline = 0;
 };
 
 #endif
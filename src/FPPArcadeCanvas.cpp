@@ -0,0 +1,542 @@
+#include <fpp-pch.h>
+
+#include <algorithm>
+#include <list>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include "FPPArcadeCanvas.h"
+#include "FPPArcadeSharedFrame.h"
+#include "FPPArcadeSnapshot.h"
+#include "FPPArcadeView.h"
+
+#include "overlays/PixelOverlayModel.h"
+
+static std::mutex sparseCanvasesLock;
+static std::list<FPPArcadeCanvas*> sparseCanvases;
+// the channel data compositeSparse() was last handed
+static std::atomic<uint8_t*> outputData{nullptr};
+
+FPPArcadeCanvas::FPPArcadeCanvas(PixelOverlayModel *m) {
+    m->getSize(physWidth, physHeight);
+    panels.push_back({m, 0, 0, physWidth, physHeight});
+    width = physWidth;
+    height = physHeight;
+    buffer.resize(width * height);
+    rebuildLUT();
+}
+
+FPPArcadeCanvas::FPPArcadeCanvas(const std::vector<PixelOverlayModel*> &models, Layout layout, int columns) {
+    if (layout == Layout::Horizontal) {
+        columns = models.size();
+    } else if (layout == Layout::Vertical) {
+        columns = 1;
+    } else if (columns < 1) {
+        columns = 1;
+    }
+    int rows = (models.size() + columns - 1) / columns;
+
+    // each grid column is as wide as its widest model, each row as tall as
+    // its tallest, smaller models sit in the top left of their cell
+    std::vector<int> colWidth(columns, 0);
+    std::vector<int> rowHeight(rows, 0);
+    for (int x = 0; x < models.size(); x++) {
+        int w, h;
+        models[x]->getSize(w, h);
+        colWidth[x % columns] = std::max(colWidth[x % columns], w);
+        rowHeight[x / columns] = std::max(rowHeight[x / columns], h);
+    }
+    std::vector<int> colX(columns, 0);
+    std::vector<int> rowY(rows, 0);
+    for (int c = 1; c < columns; c++) {
+        colX[c] = colX[c - 1] + colWidth[c - 1];
+    }
+    for (int r = 1; r < rows; r++) {
+        rowY[r] = rowY[r - 1] + rowHeight[r - 1];
+    }
+    physWidth = colX[columns - 1] + colWidth[columns - 1];
+    physHeight = rowY[rows - 1] + rowHeight[rows - 1];
+
+    for (int x = 0; x < models.size(); x++) {
+        Panel p;
+        p.model = models[x];
+        models[x]->getSize(p.width, p.height);
+        p.x = colX[x % columns];
+        p.y = rowY[x / columns];
+        panels.push_back(p);
+    }
+    width = physWidth;
+    height = physHeight;
+    buffer.resize(width * height);
+    rebuildLUT();
+}
+
+void FPPArcadeCanvas::Transform::mapDirection(int &dx, int &dy) const {
+    if (flipX) {
+        dx = -dx;
+    }
+    if (flipY) {
+        dy = -dy;
+    }
+    int x = dx;
+    int y = dy;
+    switch (rotation) {
+    case 90:
+        dx = y;
+        dy = -x;
+        break;
+    case 180:
+        dx = -x;
+        dy = -y;
+        break;
+    case 270:
+        dx = -y;
+        dy = x;
+        break;
+    }
+}
+
+void FPPArcadeCanvas::setTransform(const Transform &t) {
+    transform = t;
+    if (t.rotation == 90 || t.rotation == 270) {
+        width = physHeight;
+        height = physWidth;
+    } else {
+        width = physWidth;
+        height = physHeight;
+    }
+    buffer.assign(width * height, 0);
+    forceFlush = true;
+    if (t.isIdentity()) {
+        gather.clear();
+        physBuffer.clear();
+        return;
+    }
+
+    // Work out once where every game pixel lands so present() is a single
+    // gather over the physical surface.
+    gather.assign(physWidth * physHeight, -1);
+    physBuffer.assign(physWidth * physHeight, 0);
+    int rw = (t.rotation == 90 || t.rotation == 270) ? height : width;
+    int rh = (t.rotation == 90 || t.rotation == 270) ? width : height;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int px = x;
+            int py = y;
+            switch (t.rotation) {
+            case 90:
+                px = height - 1 - y;
+                py = x;
+                break;
+            case 180:
+                px = width - 1 - x;
+                py = height - 1 - y;
+                break;
+            case 270:
+                px = y;
+                py = width - 1 - x;
+                break;
+            }
+            if (t.flipX) {
+                px = rw - 1 - px;
+            }
+            if (t.flipY) {
+                py = rh - 1 - py;
+            }
+            px += t.offsetX;
+            py += t.offsetY;
+            if (px >= 0 && py >= 0 && px < physWidth && py < physHeight) {
+                gather[py * physWidth + px] = y * width + x;
+            }
+        }
+    }
+}
+
+FPPArcadeCanvas::~FPPArcadeCanvas() {
+    setSparse(false);
+}
+
+uint8_t FPPArcadeCanvas::color(int r, int g, int b) {
+    uint32_t c = (r << 16) | (g << 8) | b;
+    uint32_t last = lastColor.load(std::memory_order_relaxed);
+    if ((last >> 8) == c) {
+        return last & 0xFF;
+    }
+    std::lock_guard<std::mutex> l(paletteLock);
+    uint8_t idx = 0;
+    auto it = paletteIndex.find(c);
+    if (it != paletteIndex.end()) {
+        idx = it->second;
+    } else if (c == 0) {
+        idx = 0;
+    } else if (paletteSize < 256) {
+        idx = paletteSize++;
+        palette[idx] = c;
+        updateLUT(idx);
+        paletteIndex[c] = idx;
+    } else {
+        int best = INT_MAX;
+        for (int x = 0; x < 256; x++) {
+            int dr = r - ((palette[x] >> 16) & 0xFF);
+            int dg = g - ((palette[x] >> 8) & 0xFF);
+            int db = b - (palette[x] & 0xFF);
+            int d = dr * dr + dg * dg + db * db;
+            if (d < best) {
+                best = d;
+                idx = x;
+            }
+        }
+        paletteIndex[c] = idx;
+    }
+    lastColor.store((c << 8) | idx, std::memory_order_relaxed);
+    return idx;
+}
+
+void FPPArcadeCanvas::setBrightness(int b) {
+    std::lock_guard<std::mutex> l(paletteLock);
+    brightness = std::clamp(b, 0, 100);
+    rebuildLUT();
+}
+
+void FPPArcadeCanvas::setGamma(float g) {
+    std::lock_guard<std::mutex> l(paletteLock);
+    gamma = g > 0.0f ? g : 1.0f;
+    rebuildLUT();
+}
+
+void FPPArcadeCanvas::setColorOrder(const std::string &order) {
+    std::lock_guard<std::mutex> l(paletteLock);
+    if (order.size() == 3) {
+        for (int x = 0; x < 3; x++) {
+            colorOrder[x] = order[x] == 'R' ? 0 : (order[x] == 'G' ? 1 : 2);
+        }
+    }
+    rebuildLUT();
+}
+
+void FPPArcadeCanvas::rebuildLUT() {
+    for (int x = 0; x < 256; x++) {
+        float v = std::pow(x / 255.0f, gamma) * brightness * 255.0f / 100.0f;
+        curve[x] = std::lround(v);
+    }
+    palette[0] = 0;
+    for (int x = 0; x < paletteSize; x++) {
+        updateLUT(x);
+    }
+    forceFlush = true;
+}
+
+void FPPArcadeCanvas::updateLUT(int idx) {
+    uint8_t rgb[3] = {
+        curve[(palette[idx] >> 16) & 0xFF],
+        curve[(palette[idx] >> 8) & 0xFF],
+        curve[palette[idx] & 0xFF]
+    };
+    for (int x = 0; x < 3; x++) {
+        lut[idx * 3 + x] = rgb[colorOrder[x]];
+    }
+    previewLUT[idx * 3] = (palette[idx] >> 16) & 0xFF;
+    previewLUT[idx * 3 + 1] = (palette[idx] >> 8) & 0xFF;
+    previewLUT[idx * 3 + 2] = palette[idx] & 0xFF;
+}
+
+void FPPArcadeCanvas::clear() {
+    std::fill(buffer.begin(), buffer.end(), 0);
+}
+
+void FPPArcadeCanvas::serialize(FPPArcadeSnapshot &s) {
+    int w = width;
+    int h = height;
+    s.io(w);
+    s.io(h);
+    if (w != width || h != height) {
+        s.fail();
+        return;
+    }
+    s.bytes(buffer.data(), buffer.size());
+    std::lock_guard<std::mutex> l(paletteLock);
+    int size = paletteSize;
+    s.io(size);
+    if (size < 1 || size > 256) {
+        s.fail();
+        return;
+    }
+    s.bytes(palette.data(), size * sizeof(uint32_t));
+    if (!s.isLoading() || !s.isValid()) {
+        return;
+    }
+    paletteSize = size;
+    paletteIndex.clear();
+    for (int x = 1; x < paletteSize; x++) {
+        paletteIndex[palette[x]] = x;
+    }
+    lastColor = 0;
+    rebuildLUT();
+}
+
+bool FPPArcadeCanvas::present() {
+    if (sparse && !channelsMapped) {
+        mapChannels();
+    }
+    // The game buffer is one byte a pixel so comparing it to the last frame
+    // is about as cheap as hashing it, and exact.
+    if (!forceFlush.exchange(false) && buffer == lastFrame) {
+        if (!FPPArcadeView::INSTANCE.hasViewers() || !FPPArcadeView::INSTANCE.needsFrame(getPrimaryModel()->getName())) {
+            return false;
+        }
+    }
+    lastFrame = buffer;
+
+    const uint8_t *surface = buffer.data();
+    if (!gather.empty()) {
+        const uint8_t *src = buffer.data();
+        uint8_t *dst = physBuffer.data();
+        const int32_t *g = gather.data();
+        int count = gather.size();
+        for (int i = 0; i < count; i++) {
+            int32_t s = g[i];
+            dst[i] = s < 0 ? 0 : src[s];
+        }
+        surface = physBuffer.data();
+    }
+    publish(surface);
+    if (FPPArcadeView::INSTANCE.hasViewers()) {
+        FPPArcadeView::INSTANCE.publish(getPrimaryModel()->getName(), physWidth, physHeight, surface, previewLUT.data());
+    }
+    if (sparse) {
+        buildSpans(surface);
+        return true;
+    }
+    const uint8_t *l = lut.data();
+    for (auto &p : panels) {
+        uint8_t *dst = p.model->getOverlayBuffer();
+        const uint8_t *src = surface + p.y * physWidth + p.x;
+        for (int y = 0; y < p.height; y++) {
+            for (int x = 0; x < p.width; x++, dst += 3) {
+                const uint8_t *c = l + src[x] * 3;
+                dst[0] = c[0];
+                dst[1] = c[1];
+                dst[2] = c[2];
+            }
+            src += physWidth;
+        }
+        p.model->setOverlayBufferDirty(true);
+        p.model->flushOverlayBuffer();
+    }
+    return true;
+}
+
+void FPPArcadeCanvas::setState(const PixelOverlayState &state) {
+    if (sparse) {
+        // the models stay disabled, "enabled" just means our spans are drawn
+        sparseVisible = state.getState() != PixelOverlayState::PixelState::Disabled;
+        forceFlush = true;
+        return;
+    }
+    for (auto &p : panels) {
+        p.model->setState(state);
+    }
+    forceFlush = true;
+}
+
+void FPPArcadeCanvas::publish(const uint8_t *surface) {
+    if (!sharedCreated) {
+        sharedCreated = true;
+        shared = std::make_unique<FPPArcadeSharedFrame>(getPrimaryModel()->getName(), physWidth, physHeight);
+        if (!shared->isValid()) {
+            shared.reset();
+        }
+    }
+    if (!shared) {
+        return;
+    }
+    const uint8_t *l = previewLUT.data();
+    uint8_t *dst = shared->beginWrite();
+    int count = physWidth * physHeight;
+    for (int i = 0; i < count; i++, dst += 3) {
+        const uint8_t *c = l + surface[i] * 3;
+        dst[0] = c[0];
+        dst[1] = c[1];
+        dst[2] = c[2];
+    }
+    shared->endWrite();
+}
+
+void FPPArcadeCanvas::setSparse(bool s) {
+    if (s == sparse) {
+        return;
+    }
+    if (s) {
+        for (auto &p : panels) {
+            p.model->setState(PixelOverlayState(PixelOverlayState::PixelState::Disabled));
+        }
+    }
+    std::lock_guard<std::mutex> l(sparseCanvasesLock);
+    sparse = s;
+    if (s) {
+        sparseCanvases.push_back(this);
+    } else {
+        // waits for a composite in progress on the output thread
+        sparseCanvases.remove(this);
+    }
+    forceFlush = true;
+}
+
+void FPPArcadeCanvas::buildSpans(const uint8_t *surface) {
+    const uint8_t *l = lut.data();
+    sparseBack.spans.clear();
+    sparseBack.rgb.clear();
+    for (int pi = 0; pi < panels.size(); pi++) {
+        const Panel &p = panels[pi];
+        const uint8_t *row = surface + p.y * physWidth + p.x;
+        for (int y = 0; y < p.height; y++, row += physWidth) {
+            int x = 0;
+            while (x < p.width) {
+                if (row[x] == 0) {
+                    x++;
+                    continue;
+                }
+                Span span;
+                span.panel = pi;
+                span.x = x;
+                span.y = y;
+                span.offset = sparseBack.rgb.size();
+                while (x < p.width && row[x] != 0) {
+                    const uint8_t *c = l + row[x] * 3;
+                    sparseBack.rgb.insert(sparseBack.rgb.end(), c, c + 3);
+                    x++;
+                }
+                span.length = x - span.x;
+                sparseBack.spans.push_back(span);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lk(sparseLock);
+    std::swap(sparseFront, sparseBack);
+}
+
+// FPP doesn't expose a model's channel map, so it is learned once, on the
+// game thread, by drawing every pixel through setPixelValue() and seeing
+// where the values land in the channel data.  The output thread is held
+// off the channel data meanwhile and it is put back afterwards.
+void FPPArcadeCanvas::mapChannels() {
+    uint8_t *seqData = outputData;
+    if (seqData == nullptr) {
+        // nothing output yet, composite() draws through the models until
+        // the next present()
+        return;
+    }
+    channelsMapped = true;
+    std::vector<ChannelMap> maps(panels.size());
+    {
+        std::lock_guard<std::mutex> l(sparseCanvasesLock);
+        for (int pi = 0; pi < panels.size(); pi++) {
+            if (!mapPanel(panels[pi].model, seqData, maps[pi])) {
+                LogWarn(VB_PLUGIN, "Could not find the channels of model %s, drawing through the model instead\n",
+                        panels[pi].model->getName().c_str());
+                maps[pi].pixels.clear();
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lk(sparseLock);
+    channelMaps.swap(maps);
+}
+
+// Three passes of one byte each number every pixel channel (plus one, so
+// untouched channels read 0).  One pixel is tried first so a model that
+// doesn't draw into seqData is left as it was.
+bool FPPArcadeCanvas::mapPanel(PixelOverlayModel *m, uint8_t *seqData, ChannelMap &map) {
+    int w = m->getWidth();
+    int h = m->getHeight();
+    int start = m->getStartChannel();
+    int count = m->getChannelCount();
+    if (count < w * h * 3) {
+        return false;
+    }
+    uint8_t *chan = seqData + start;
+    std::vector<uint8_t> saved(chan, chan + count);
+
+    int r, g, b;
+    m->getPixelValue(0, 0, r, g, b);
+    m->setPixelValue(0, 0, r ^ 0xFF, g ^ 0xFF, b ^ 0xFF);
+    if (memcmp(chan, saved.data(), count) == 0) {
+        m->setPixelValue(0, 0, r, g, b);
+        return false;
+    }
+
+    std::vector<uint32_t> code(count, 0);
+    for (int pass = 0; pass < 3; pass++) {
+        int shift = pass * 8;
+        memset(chan, 0, count);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                uint32_t n = (y * w + x) * 3 + 1;
+                m->setPixelValue(x, y, (n >> shift) & 0xFF, ((n + 1) >> shift) & 0xFF, ((n + 2) >> shift) & 0xFF);
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            code[i] |= (uint32_t)chan[i] << shift;
+        }
+    }
+    memcpy(chan, saved.data(), count);
+
+    std::vector<int32_t> found(w * h * 3, -1);
+    for (int i = 0; i < count; i++) {
+        if (code[i] != 0 && code[i] <= found.size()) {
+            found[code[i] - 1] = start + i;
+        }
+    }
+    // every pixel has to have its channels the same way round
+    map.width = w;
+    map.pixels.resize(w * h);
+    for (int p = 0; p < w * h; p++) {
+        const int32_t *f = &found[p * 3];
+        if (f[0] < 0 || f[1] < 0 || f[2] < 0) {
+            return false;
+        }
+        int32_t base = std::min({f[0], f[1], f[2]});
+        if (p == 0) {
+            for (int c = 0; c < 3; c++) {
+                map.rgb[c] = f[c] - base;
+            }
+        } else if (f[0] - base != map.rgb[0] || f[1] - base != map.rgb[1] || f[2] - base != map.rgb[2]) {
+            return false;
+        }
+        map.pixels[p] = base;
+    }
+    return true;
+}
+
+void FPPArcadeCanvas::composite(uint8_t *seqData) {
+    if (!sparseVisible) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(sparseLock);
+    for (auto &span : sparseFront.spans) {
+        const uint8_t *c = &sparseFront.rgb[span.offset];
+        if (span.panel >= channelMaps.size() || channelMaps[span.panel].pixels.empty()) {
+            PixelOverlayModel *m = panels[span.panel].model;
+            for (int x = 0; x < span.length; x++, c += 3) {
+                m->setPixelValue(span.x + x, span.y, c[0], c[1], c[2]);
+            }
+            continue;
+        }
+        const ChannelMap &map = channelMaps[span.panel];
+        const int32_t *px = &map.pixels[span.y * map.width + span.x];
+        for (int x = 0; x < span.length; x++, c += 3) {
+            uint8_t *d = seqData + px[x];
+            d[map.rgb[0]] = c[0];
+            d[map.rgb[1]] = c[1];
+            d[map.rgb[2]] = c[2];
+        }
+    }
+}
+
+void FPPArcadeCanvas::compositeSparse(uint8_t *seqData) {
+    outputData = seqData;
+    std::lock_guard<std::mutex> l(sparseCanvasesLock);
+    for (auto c : sparseCanvases) {
+        c->composite(seqData);
+    }
+}
@@ -0,0 +1,209 @@
+#ifndef __FPPARCADE_CANVAS__
+#define __FPPARCADE_CANVAS__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class FPPArcadeSharedFrame;
+class FPPArcadeSnapshot;
+class PixelOverlayModel;
+class PixelOverlayState;
+
+// The logical surface a game draws on.  Normally that is exactly one
+// overlay model, but a canvas can also be laid out across several models
+// (a row of panels that aren't merged into one virtual model).  Games draw
+// into the canvas' own buffer and present() copies each model's slice
+// into its overlay buffer a row at a time, so there is no per-pixel
+// routing.
+//
+// Pixels are 8 bit indexes into a 256 entry palette that is filled as the
+// game asks for colors.  present() expands them through a lookup table
+// that already has the brightness, gamma and color order applied, so
+// changing any of those only rebuilds 256 entries.
+class FPPArcadeCanvas {
+public:
+    enum class Layout {
+        Horizontal,
+        Vertical,
+        Grid
+    };
+
+    // How the game's picture is placed on the physical models: rotated
+    // clockwise, then mirrored, then shifted by the offset.
+    class Transform {
+    public:
+        int rotation = 0; // 0, 90, 180 or 270
+        bool flipX = false;
+        bool flipY = false;
+        int offsetX = 0;
+        int offsetY = 0;
+
+        bool isIdentity() const {
+            return rotation == 0 && !flipX && !flipY && offsetX == 0 && offsetY == 0;
+        }
+        // turn a direction as seen on the models into the game's direction
+        void mapDirection(int &dx, int &dy) const;
+    };
+
+    class Panel {
+    public:
+        PixelOverlayModel *model;
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    FPPArcadeCanvas(PixelOverlayModel *m);
+    // models[0] is the primary model that runs the effect.  For Grid the
+    // models fill rows of "columns" models, left to right, top to bottom.
+    FPPArcadeCanvas(const std::vector<PixelOverlayModel*> &models, Layout layout, int columns = 1);
+    ~FPPArcadeCanvas();
+
+    // logical game surface, after undoing the rotation
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void setTransform(const Transform &t);
+    const Transform &getTransform() const { return transform; }
+    PixelOverlayModel *getPrimaryModel() const { return panels[0].model; }
+    const std::vector<Panel> &getPanels() const { return panels; }
+
+    // palette indexes, row major, getWidth() * getHeight() bytes
+    uint8_t *getBuffer() { return buffer.data(); }
+
+    // Palette index for a color, adding it if needed.  Index 0 is always
+    // black.  Once all 256 entries are used the closest one is returned.
+    uint8_t color(int r, int g, int b);
+    // 0xRRGGBB of a palette index, before brightness and gamma
+    uint32_t getPaletteColor(uint8_t idx) const { return palette[idx]; }
+
+    // 0-100
+    void setBrightness(int b);
+    int getBrightness() const { return brightness; }
+    void setGamma(float g);
+    // "RGB", "GRB", "BGR" etc, the order the bytes are written to the model
+    void setColorOrder(const std::string &order);
+
+    void clear();
+    // the picture and the palette, see FPPArcadeSnapshot.  Loading fails
+    // unless the canvas is the same size as the one saved.
+    void serialize(FPPArcadeSnapshot &s);
+    void setPixel(int x, int y, uint8_t c) {
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+            return;
+        }
+        buffer[y * width + x] = c;
+    }
+    void setPixel(int x, int y, int r, int g, int b) {
+        setPixel(x, y, color(r, g, b));
+    }
+
+    // apply the transform (if any) in one pass over the whole surface, then
+    // copy every panel's slice to its model and flush them.  Returns false,
+    // without touching the models, if the frame is identical to the last
+    // one presented.
+    bool present();
+    void setState(const PixelOverlayState &state);
+
+    // Sparse mode, used for transparent games.  The models stay disabled so
+    // FPP doesn't blend every black pixel, and present() just records the
+    // runs of lit pixels.  compositeSparse() writes those into the channel
+    // data about to be output, at each model's channels, so the cost
+    // follows the number of lit pixels rather than the size of the models.
+    void setSparse(bool s);
+    bool isSparse() const { return sparse; }
+    // called from the channel output thread for all sparse canvases
+    static void compositeSparse(uint8_t *seqData);
+
+private:
+    class Span {
+    public:
+        uint16_t panel;
+        uint16_t x;
+        uint16_t y;
+        uint16_t length;
+        // into SparseFrame::rgb
+        uint32_t offset;
+    };
+    class SparseFrame {
+    public:
+        std::vector<Span> spans;
+        std::vector<uint8_t> rgb;
+    };
+    void buildSpans(const uint8_t *surface);
+    void publish(const uint8_t *surface);
+    // where a panel's pixels are in the channel data
+    class ChannelMap {
+    public:
+        int width = 0;
+        // first channel of each pixel, row major, empty if the model
+        // couldn't be mapped and composite() has to use setPixelValue()
+        std::vector<int32_t> pixels;
+        // red, green and blue from that channel
+        std::array<int, 3> rgb = {0, 1, 2};
+    };
+    void composite(uint8_t *seqData);
+    void mapChannels();
+    static bool mapPanel(PixelOverlayModel *m, uint8_t *seqData, ChannelMap &map);
+
+    int width = 0;
+    int height = 0;
+    int physWidth = 0;
+    int physHeight = 0;
+    std::vector<Panel> panels;
+    std::vector<uint8_t> buffer;
+
+    void rebuildLUT();
+    void updateLUT(int idx);
+
+    Transform transform;
+    // physical pixel -> logical pixel, -1 for pixels the picture doesn't cover
+    std::vector<int32_t> gather;
+    std::vector<uint8_t> physBuffer;
+
+    // last frame presented, to skip flushing unchanged frames
+    std::vector<uint8_t> lastFrame;
+    // set when something other than the pixels changed the output
+    std::atomic<bool> forceFlush{true};
+
+    std::mutex paletteLock;
+    std::array<uint32_t, 256> palette;
+    int paletteSize = 1;
+    std::unordered_map<uint32_t, uint8_t> paletteIndex;
+    // color << 8 | its index, one word so color() can check it without
+    // the lock from any thread
+    std::atomic<uint32_t> lastColor{0};
+
+    int brightness = 100;
+    float gamma = 1.0f;
+    std::array<int, 3> colorOrder = {0, 1, 2};
+    std::array<uint8_t, 256> curve;
+    std::array<uint8_t, 256 * 3> lut;
+    // the palette as plain RGB, without brightness, gamma or color order,
+    // for the shared frame and the viewers
+    std::array<uint8_t, 256 * 3> previewLUT{};
+
+    bool sparse = false;
+    std::atomic<bool> sparseVisible{false};
+    std::mutex sparseLock;
+    // built by present() into back, swapped into front for composite()
+    SparseFrame sparseFront;
+    SparseFrame sparseBack;
+    // per panel, built by present() the first time the channel data is
+    // known, see mapChannels()
+    std::vector<ChannelMap> channelMaps;
+    bool channelsMapped = false;
+
+    // the whole surface, for previews, see FPPArcadeSharedFrame
+    std::unique_ptr<FPPArcadeSharedFrame> shared;
+    bool sharedCreated = false;
+};
+
+#endif
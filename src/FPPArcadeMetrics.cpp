@@ -0,0 +1,134 @@
+#include <fpp-pch.h>
+
+#include "FPPArcadeMetrics.h"
+
+FPPArcadeMetrics FPPArcadeMetrics::INSTANCE;
+
+constexpr std::array<uint64_t, 13> FPPArcadeHistogram::BOUNDS;
+
+static std::string escapeLabel(const std::string &s) {
+    std::string r;
+    r.reserve(s.size());
+    for (auto ch : s) {
+        if (ch == '"' || ch == '\\') {
+            r += '\\';
+            r += ch;
+        } else if (ch == '\n') {
+            r += "\\n";
+        } else {
+            r += ch;
+        }
+    }
+    return r;
+}
+
+static std::string toSeconds(uint64_t us) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%g", us / 1000000.0);
+    return buf;
+}
+
+void FPPArcadeHistogram::observe(uint64_t us) {
+    int b = 0;
+    while (b < BOUNDS.size() && us > BOUNDS[b]) {
+        b++;
+    }
+    buckets[b].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(us, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FPPArcadeHistogram::write(std::string &out, const std::string &name, const std::string &labels) const {
+    std::string sep = labels.empty() ? "" : ",";
+    uint64_t cumulative = 0;
+    for (int b = 0; b < BOUNDS.size(); b++) {
+        cumulative += buckets[b].load(std::memory_order_relaxed);
+        out += name + "_bucket{" + labels + sep + "le=\"" + toSeconds(BOUNDS[b]) + "\"} " + std::to_string(cumulative) + "\n";
+    }
+    cumulative += buckets[BOUNDS.size()].load(std::memory_order_relaxed);
+    out += name + "_bucket{" + labels + sep + "le=\"+Inf\"} " + std::to_string(cumulative) + "\n";
+    out += name + "_sum{" + labels + "} " + toSeconds(sum.load(std::memory_order_relaxed)) + "\n";
+    out += name + "_count{" + labels + "} " + std::to_string(count.load(std::memory_order_relaxed)) + "\n";
+}
+
+FPPArcadeGameMetrics *FPPArcadeMetrics::getGameMetrics(const std::string &game) {
+    std::lock_guard<std::mutex> l(lock);
+    for (auto &g : games) {
+        if (g.name == game) {
+            return &g;
+        }
+    }
+    games.emplace_back(game);
+    return &games.back();
+}
+
+FPPArcadeControllerMetrics *FPPArcadeMetrics::getControllerMetrics(const std::string &controller) {
+    std::lock_guard<std::mutex> l(lock);
+    for (auto &c : controllers) {
+        if (c.name == controller) {
+            return &c;
+        }
+    }
+    controllers.emplace_back(controller);
+    return &controllers.back();
+}
+
+std::string FPPArcadeMetrics::toPrometheus() {
+    std::string out;
+    std::lock_guard<std::mutex> l(lock);
+
+    out += "# HELP arcade_controller_events_total Joystick/gamepad events processed per controller\n";
+    out += "# TYPE arcade_controller_events_total counter\n";
+    for (auto &c : controllers) {
+        out += "arcade_controller_events_total{controller=\"" + escapeLabel(c.name) + "\"} " + std::to_string(c.events.get()) + "\n";
+    }
+
+    out += "# HELP arcade_commands_total FPP Arcade commands dispatched\n";
+    out += "# TYPE arcade_commands_total counter\n";
+    out += "arcade_commands_total{command=\"FPP Arcade Button\"} " + std::to_string(buttonCommands.get()) + "\n";
+    out += "arcade_commands_total{command=\"FPP Arcade Axis\"} " + std::to_string(axisCommands.get()) + "\n";
+    out += "arcade_commands_total{command=\"FPP Arcade Select Game\"} " + std::to_string(selectCommands.get()) + "\n";
+
+    out += "# HELP arcade_games_started_total Game sessions started\n";
+    out += "# TYPE arcade_games_started_total counter\n";
+    for (auto &g : games) {
+        out += "arcade_games_started_total{game=\"" + escapeLabel(g.name) + "\"} " + std::to_string(g.started.get()) + "\n";
+    }
+    out += "# HELP arcade_games_ended_total Game sessions ended\n";
+    out += "# TYPE arcade_games_ended_total counter\n";
+    for (auto &g : games) {
+        out += "arcade_games_ended_total{game=\"" + escapeLabel(g.name) + "\"} " + std::to_string(g.ended.get()) + "\n";
+    }
+    out += "# HELP arcade_frames_skipped_total Ticks missed because update() ran late\n";
+    out += "# TYPE arcade_frames_skipped_total counter\n";
+    for (auto &g : games) {
+        out += "arcade_frames_skipped_total{game=\"" + escapeLabel(g.name) + "\"} " + std::to_string(g.framesSkipped.get()) + "\n";
+    }
+    out += "# HELP arcade_presents_unchanged_total Presents skipped because the frame was identical to the last one\n";
+    out += "# TYPE arcade_presents_unchanged_total counter\n";
+    for (auto &g : games) {
+        out += "arcade_presents_unchanged_total{game=\"" + escapeLabel(g.name) + "\"} " + std::to_string(g.presentsUnchanged.get()) + "\n";
+    }
+
+    out += "# HELP arcade_update_duration_seconds Time spent in a game's update()\n";
+    out += "# TYPE arcade_update_duration_seconds histogram\n";
+    for (auto &g : games) {
+        g.updateTime.write(out, "arcade_update_duration_seconds", "game=\"" + escapeLabel(g.name) + "\"");
+    }
+    out += "# HELP arcade_present_duration_seconds Time spent presenting/flushing the overlay buffer\n";
+    out += "# TYPE arcade_present_duration_seconds histogram\n";
+    for (auto &g : games) {
+        g.presentTime.write(out, "arcade_present_duration_seconds", "game=\"" + escapeLabel(g.name) + "\"");
+    }
+    out += "# HELP arcade_tick_requested_seconds Tick interval requested by update()\n";
+    out += "# TYPE arcade_tick_requested_seconds histogram\n";
+    for (auto &g : games) {
+        g.requestedInterval.write(out, "arcade_tick_requested_seconds", "game=\"" + escapeLabel(g.name) + "\"");
+    }
+    out += "# HELP arcade_tick_actual_seconds Tick interval actually observed between update() calls\n";
+    out += "# TYPE arcade_tick_actual_seconds histogram\n";
+    for (auto &g : games) {
+        g.actualInterval.write(out, "arcade_tick_actual_seconds", "game=\"" + escapeLabel(g.name) + "\"");
+    }
+    return out;
+}
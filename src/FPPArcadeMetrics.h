@@ -0,0 +1,81 @@
+#ifndef __FPPARCADE_METRICS__
+#define __FPPARCADE_METRICS__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+
+// Counters and histograms are plain relaxed atomics so the input and
+// overlay threads can update them without taking a lock.  Only the lookup
+// of a per-game/per-controller block takes the mutex and callers are
+// expected to do that once and hold on to the returned pointer.
+class FPPArcadeCounter {
+public:
+    void inc(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+class FPPArcadeHistogram {
+public:
+    // bucket upper bounds in microseconds, the last bucket is +Inf
+    static constexpr std::array<uint64_t, 13> BOUNDS = {
+        100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+    };
+
+    void observe(uint64_t us);
+    void write(std::string &out, const std::string &name, const std::string &labels) const;
+private:
+    std::array<std::atomic<uint64_t>, BOUNDS.size() + 1> buckets{};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> count{0};
+};
+
+class FPPArcadeGameMetrics {
+public:
+    FPPArcadeGameMetrics(const std::string &n) : name(n) {}
+
+    const std::string name;
+    FPPArcadeHistogram updateTime;
+    FPPArcadeHistogram presentTime;
+    FPPArcadeHistogram requestedInterval;
+    FPPArcadeHistogram actualInterval;
+    FPPArcadeCounter framesSkipped;
+    FPPArcadeCounter presentsUnchanged;
+    FPPArcadeCounter started;
+    FPPArcadeCounter ended;
+};
+
+class FPPArcadeControllerMetrics {
+public:
+    FPPArcadeControllerMetrics(const std::string &n) : name(n) {}
+
+    const std::string name;
+    FPPArcadeCounter events;
+};
+
+class FPPArcadeMetrics {
+public:
+    static FPPArcadeMetrics INSTANCE;
+
+    // returned pointers stay valid for the life of the plugin
+    FPPArcadeGameMetrics *getGameMetrics(const std::string &game);
+    FPPArcadeControllerMetrics *getControllerMetrics(const std::string &controller);
+
+    FPPArcadeCounter buttonCommands;
+    FPPArcadeCounter axisCommands;
+    FPPArcadeCounter selectCommands;
+
+    // Prometheus text exposition format
+    std::string toPrometheus();
+private:
+    std::mutex lock;
+    std::list<FPPArcadeGameMetrics> games;
+    std::list<FPPArcadeControllerMetrics> controllers;
+};
+
+#endif
@@ -0,0 +1,330 @@
+#include <fpp-pch.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "FPPArcade.h"
+#include "FPPArcadeNetplay.h"
+#include "FPPArcadeTrace.h"
+
+#include "common.h"
+#include "log.h"
+
+static constexpr uint32_t PACKET_MAGIC = 0x4641504E;
+// magic, session, side, count, advantage, frame, ack, first, hashFrame, hash
+static constexpr int PACKET_HEADER = 4 + 4 + 1 + 1 + 2 + 4 + 4 + 4 + 4 + 4;
+static constexpr uint64_t PEER_TIMEOUT_MS = 5000;
+
+static void put32(std::vector<uint8_t> &v, uint32_t x) {
+    x = htonl(x);
+    const uint8_t *b = reinterpret_cast<const uint8_t*>(&x);
+    v.insert(v.end(), b, b + 4);
+}
+static uint32_t get32(const uint8_t *p) {
+    uint32_t x;
+    memcpy(&x, p, 4);
+    return ntohl(x);
+}
+
+FPPArcadeNetplay::FPPArcadeNetplay(const FPPArcadeNetplayOptions &o, FPPArcadeGameEffect *e, FPPArcadeNetGame *g, int ms) :
+    options(o), effect(e), game(g), frameMS(ms) {
+    local.fill(0);
+    remote.fill(0);
+    used.fill(0);
+    hashes.fill(0);
+    // frames before the input delay has passed have no input on either side
+    localKnown = options.inputDelay;
+
+    // both nodes have to be running the same game on the same size board
+    std::string id = e->name() + ":" + std::to_string(e->getWidth()) + "x" + std::to_string(e->getHeight()) + ":" + std::to_string(ms);
+    session = 2166136261u;
+    for (auto c : id) {
+        session = (session ^ (uint8_t)c) * 16777619u;
+    }
+
+    if (!resolvePeer(options.peer, options.port)) {
+        return;
+    }
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        LogErr(VB_PLUGIN, "FPP Arcade Netplay: could not create socket: %s\n", strerror(errno));
+        return;
+    }
+    int on = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(options.port);
+    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        LogErr(VB_PLUGIN, "FPP Arcade Netplay: could not bind UDP port %d: %s\n", options.port, strerror(errno));
+        close(sock);
+        sock = -1;
+        return;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+    LogInfo(VB_PLUGIN, "FPP Arcade Netplay: %s as player %d on port %d, waiting for %s\n",
+            e->name().c_str(), options.side + 1, options.port, options.peer.c_str());
+}
+
+FPPArcadeNetplay::~FPPArcadeNetplay() {
+    if (sock >= 0) {
+        close(sock);
+    }
+    if (frame) {
+        LogInfo(VB_PLUGIN, "FPP Arcade Netplay: %u frames, %llu rollbacks resimulating %llu frames (at most %d at once), %llu frames waiting for the peer%s\n",
+                frame, (unsigned long long)rollbacks, (unsigned long long)resimulated, maxRollback,
+                (unsigned long long)stalls, desynced ? ", DESYNCED" : "");
+    }
+}
+
+bool FPPArcadeNetplay::resolvePeer(const std::string &peer, int defPort) {
+    std::string host = peer;
+    int port = defPort;
+    size_t colon = peer.rfind(':');
+    if (colon != std::string::npos) {
+        host = peer.substr(0, colon);
+        port = std::atoi(peer.substr(colon + 1).c_str());
+    }
+    if (host.empty() || port <= 0 || port > 65535) {
+        LogErr(VB_PLUGIN, "FPP Arcade Netplay: peer \"%s\" is not host:port\n", peer.c_str());
+        return false;
+    }
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *res = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &res) != 0 || res == nullptr) {
+        LogErr(VB_PLUGIN, "FPP Arcade Netplay: could not resolve peer \"%s\"\n", host.c_str());
+        return false;
+    }
+    memcpy(&peerAddr, res->ai_addr, sizeof(peerAddr));
+    peerAddr.sin_port = htons(port);
+    freeaddrinfo(res);
+    return true;
+}
+
+void FPPArcadeNetplay::button(const std::string &button) {
+    std::lock_guard<std::mutex> l(inputLock);
+    localInput = game->netInput(localInput, button);
+}
+
+int32_t FPPArcadeNetplay::update() {
+    ARCADE_TRACE("netplay");
+    uint64_t now = GetTimeMS();
+    bool connecting = state == State::Connecting;
+    receive(now);
+    flushOutgoing(now);
+    if (state == State::Lost) {
+        return frameMS;
+    }
+    if (connecting) {
+        // Empty packets say hello.  Frame 0 is simulated on the update
+        // after the peer's first packet arrives, so the game can get its
+        // board ready once it sees we are running.
+        sendInputs(now);
+        return frameMS;
+    }
+    if (now - lastReceived > PEER_TIMEOUT_MS) {
+        LogWarn(VB_PLUGIN, "FPP Arcade Netplay: nothing from the peer for %d ms, ending the session\n", (int)PEER_TIMEOUT_MS);
+        state = State::Lost;
+        return frameMS;
+    }
+    if (rollbackTo != NONE) {
+        rollback();
+    }
+
+    int32_t next = frameMS;
+    if (frame >= remoteKnown + MAX_ROLLBACK) {
+        // too far ahead of what we know of the peer, wait for it
+        stalls++;
+    } else {
+        {
+            std::lock_guard<std::mutex> l(inputLock);
+            local[localKnown % RING] = localInput;
+        }
+        localKnown++;
+        stepFrame(frame);
+        frame++;
+
+        // How far each side thinks it is ahead of the other.  Latency
+        // makes both look ahead by the same amount, so half the
+        // difference is how far we really are in front.
+        int advantage = (int)frame - (int)remoteFrame;
+        if (advantage - remoteAdvantage > 2) {
+            next += frameMS / 8;
+        }
+    }
+    sendInputs(now);
+    checkHash();
+    return next;
+}
+
+void FPPArcadeNetplay::stepFrame(uint32_t f) {
+    int idx = f % RING;
+    effect->snapshot(states[idx]);
+    hashes[idx] = effect->stateHash();
+    uint8_t in[2];
+    int other = 1 - options.side;
+    in[options.side] = local[idx];
+    if (f < remoteKnown) {
+        in[other] = remote[idx];
+    } else {
+        // predict the peer keeps doing what it was last seen doing
+        in[other] = remoteKnown ? remote[(remoteKnown - 1) % RING] : 0;
+    }
+    used[idx] = in[other];
+    game->netStep(in);
+}
+
+void FPPArcadeNetplay::rollback() {
+    ARCADE_TRACE("rollback");
+    uint32_t from = rollbackTo;
+    rollbackTo = NONE;
+    if (!effect->restore(states[from % RING])) {
+        LogErr(VB_PLUGIN, "FPP Arcade Netplay: could not roll back to frame %u\n", from);
+        return;
+    }
+    for (uint32_t f = from; f < frame; f++) {
+        stepFrame(f);
+    }
+    rollbacks++;
+    resimulated += frame - from;
+    maxRollback = std::max(maxRollback, (int)(frame - from));
+}
+
+void FPPArcadeNetplay::receive(uint64_t now) {
+    uint8_t buf[PACKET_HEADER + MAX_INPUTS];
+    while (sock >= 0) {
+        sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        int len = recvfrom(sock, buf, sizeof(buf), 0, (sockaddr*)&from, &fromLen);
+        if (len < 0) {
+            return;
+        }
+        if (from.sin_addr.s_addr != peerAddr.sin_addr.s_addr || from.sin_port != peerAddr.sin_port) {
+            continue;
+        }
+        handlePacket(buf, len, now);
+    }
+}
+
+void FPPArcadeNetplay::handlePacket(const uint8_t *p, int len, uint64_t now) {
+    if (len < PACKET_HEADER || get32(p) != PACKET_MAGIC) {
+        return;
+    }
+    int side = p[8];
+    int count = p[9];
+    if (get32(p + 4) != session || side == options.side || len < PACKET_HEADER + count) {
+        if (!mismatchLogged) {
+            mismatchLogged = true;
+            LogErr(VB_PLUGIN, "FPP Arcade Netplay: ignoring the peer, it is %s\n",
+                   side == options.side ? "playing the same side" : "running a different game or board size");
+        }
+        return;
+    }
+    lastReceived = now;
+    if (state == State::Connecting) {
+        LogInfo(VB_PLUGIN, "FPP Arcade Netplay: connected to %s\n", options.peer.c_str());
+        state = State::Running;
+    }
+    remoteAdvantage = (int16_t)(((uint16_t)p[10] << 8) | p[11]);
+    remoteFrame = std::max(remoteFrame, get32(p + 12));
+    peerAck = std::max(peerAck, get32(p + 16));
+    uint32_t first = get32(p + 20);
+    uint32_t hashFrame = get32(p + 24);
+    if (hashFrame != NONE) {
+        peerHashFrame = hashFrame;
+        peerHash = get32(p + 28);
+    }
+    const uint8_t *inputs = p + PACKET_HEADER;
+    for (int x = 0; x < count; x++) {
+        uint32_t f = first + x;
+        if (f < remoteKnown) {
+            continue;
+        }
+        if (f > remoteKnown) {
+            break;
+        }
+        int idx = f % RING;
+        remote[idx] = inputs[x];
+        if (f < frame && used[idx] != inputs[x] && (rollbackTo == NONE || f < rollbackTo)) {
+            rollbackTo = f;
+        }
+        remoteKnown++;
+    }
+}
+
+void FPPArcadeNetplay::sendInputs(uint64_t now) {
+    uint32_t first = std::max(peerAck, localKnown > MAX_INPUTS ? localKnown - MAX_INPUTS : 0);
+    int count = localKnown - first;
+    if (state == State::Connecting) {
+        // hello packets carry no inputs and go out once a frame
+        if (now - lastSent < frameMS) {
+            return;
+        }
+        first = 0;
+        count = 0;
+    }
+    // the state before hashFrame only depends on confirmed inputs
+    uint32_t hashFrame = NONE;
+    if (frame > 0) {
+        hashFrame = std::min(frame - 1, remoteKnown);
+    }
+    int16_t advantage = (int)frame - (int)remoteFrame;
+
+    std::vector<uint8_t> v;
+    v.reserve(PACKET_HEADER + count);
+    put32(v, PACKET_MAGIC);
+    put32(v, session);
+    v.push_back(options.side);
+    v.push_back(count);
+    v.push_back((uint16_t)advantage >> 8);
+    v.push_back((uint16_t)advantage & 0xFF);
+    put32(v, frame);
+    put32(v, remoteKnown);
+    put32(v, first);
+    put32(v, hashFrame);
+    put32(v, hashFrame == NONE ? 0 : hashes[hashFrame % RING]);
+    for (uint32_t f = first; f < first + count; f++) {
+        v.push_back(local[f % RING]);
+    }
+    lastSent = now;
+    send(std::move(v), now);
+}
+
+void FPPArcadeNetplay::send(std::vector<uint8_t> &&data, uint64_t now) {
+    if (options.loss && (int)(lossRng() % 100) < options.loss) {
+        return;
+    }
+    if (options.latency) {
+        outgoing.push_back({now + options.latency, std::move(data)});
+        return;
+    }
+    sendto(sock, data.data(), data.size(), 0, (sockaddr*)&peerAddr, sizeof(peerAddr));
+}
+
+void FPPArcadeNetplay::flushOutgoing(uint64_t now) {
+    while (!outgoing.empty() && outgoing.front().due <= now) {
+        Outgoing &o = outgoing.front();
+        sendto(sock, o.data.data(), o.data.size(), 0, (sockaddr*)&peerAddr, sizeof(peerAddr));
+        outgoing.pop_front();
+    }
+}
+
+void FPPArcadeNetplay::checkHash() {
+    if (peerHashFrame == NONE || peerHashFrame >= frame || peerHashFrame > remoteKnown) {
+        // we haven't got that far with confirmed inputs yet
+        return;
+    }
+    if (frame - peerHashFrame < RING && hashes[peerHashFrame % RING] != peerHash && !desynced) {
+        desynced = true;
+        LogErr(VB_PLUGIN, "FPP Arcade Netplay: the game state differs from the peer's at frame %u\n", peerHashFrame);
+    }
+    peerHashFrame = NONE;
+}
@@ -0,0 +1,171 @@
+#ifndef __FPPARCADE_NETPLAY__
+#define __FPPARCADE_NETPLAY__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+
+class FPPArcadeGameEffect;
+
+// The "Netplay" options of games that can be played across two nodes.
+class FPPArcadeNetplayOptions {
+public:
+    bool enabled = false;
+    // UDP port we listen on
+    int port = 7531;
+    // "host:port" of the other node, the port defaults to ours
+    std::string peer;
+    // 0 is player 1 (left paddle, first cycle), 1 is player 2
+    int side = 0;
+    // frames between a button press and the frame it applies to, hides
+    // that much latency without any rollback
+    int inputDelay = 2;
+    // For testing on one machine: every packet we send is held back this
+    // many ms and this percentage of them is dropped.
+    int latency = 0;
+    int loss = 0;
+};
+
+// Implemented by effects that can be played over FPPArcadeNetplay.
+class FPPArcadeNetGame {
+public:
+    virtual ~FPPArcadeNetGame() {}
+
+    // Advance the game one frame with inputs[0] for side 0 and inputs[1]
+    // for side 1.  The result may depend on nothing but the game state
+    // (as serialized) and the inputs, both nodes run it independently.
+    virtual void netStep(const uint8_t *inputs) = 0;
+    // the local input after a button event, starting from current
+    virtual uint8_t netInput(uint8_t current, const std::string &button) = 0;
+};
+
+// Two node rollback netplay.  Both nodes run the whole game and only
+// exchange inputs, one byte per frame per side.  Frames are simulated
+// straight away with the other side's input predicted to be the same as
+// its last known one.  When the real input turns up and differs, the
+// game is put back to the snapshot from before that frame and the frames
+// since are simulated again, all within one update.
+//
+// Every packet carries all of our inputs the peer hasn't acknowledged
+// yet, so a lost packet costs nothing as long as a later one arrives.
+// A node that gets MAX_ROLLBACK frames ahead of the inputs it has waits,
+// and one that is ahead on average stretches its frames a little so
+// the two stay in step.  Hashes of confirmed states are exchanged so a
+// desync is logged rather than silently played through.
+class FPPArcadeNetplay {
+public:
+    enum class State {
+        Connecting,
+        Running,
+        // no packets from the peer for a while, the session is over
+        Lost
+    };
+
+    static constexpr int MAX_ROLLBACK = 16;
+
+    // e and g are the same effect, which must outlive this
+    FPPArcadeNetplay(const FPPArcadeNetplayOptions &o, FPPArcadeGameEffect *e, FPPArcadeNetGame *g, int frameMS);
+    ~FPPArcadeNetplay();
+
+    // false if the socket couldn't be set up, the reason has been logged
+    bool isValid() const { return sock >= 0; }
+    State getState() const { return state; }
+    int getSide() const { return options.side; }
+
+    // local button event, from any thread
+    void button(const std::string &button);
+
+    // Called from the effect's updateGame().  Takes in the peer's
+    // packets, rolls back and resimulates if a prediction was wrong,
+    // advances at most one frame and sends our inputs.  Returns the ms
+    // until it wants to be called again.
+    int32_t update();
+
+    // the inputs of every frame simulated so far are known, so what is
+    // on screen is final (the game can end on it)
+    bool isConfirmed() const { return frame <= remoteKnown; }
+    uint32_t getFrame() const { return frame; }
+
+private:
+    static constexpr int RING = 128;
+    static constexpr int MAX_INPUTS = 128;
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+    class Outgoing {
+    public:
+        uint64_t due;
+        std::vector<uint8_t> data;
+    };
+
+    bool resolvePeer(const std::string &peer, int defPort);
+    void receive(uint64_t now);
+    void handlePacket(const uint8_t *data, int len, uint64_t now);
+    void sendInputs(uint64_t now);
+    void send(std::vector<uint8_t> &&data, uint64_t now);
+    void flushOutgoing(uint64_t now);
+    // save the state before frame f and simulate it
+    void stepFrame(uint32_t f);
+    void rollback();
+    void checkHash();
+
+    FPPArcadeNetplayOptions options;
+    FPPArcadeGameEffect *effect;
+    FPPArcadeNetGame *game;
+    int frameMS;
+    uint32_t session = 0;
+
+    int sock = -1;
+    sockaddr_in peerAddr;
+    std::atomic<State> state{State::Connecting};
+    uint64_t lastReceived = 0;
+    uint64_t lastSent = 0;
+
+    std::mutex inputLock;
+    uint8_t localInput = 0;
+
+    // per frame, indexed by frame % RING
+    std::array<uint8_t, RING> local;
+    std::array<uint8_t, RING> remote;
+    // the remote input each frame was last simulated with
+    std::array<uint8_t, RING> used;
+    std::array<std::vector<uint8_t>, RING> states;
+    std::array<uint32_t, RING> hashes;
+
+    // next frame to simulate
+    uint32_t frame = 0;
+    // local inputs are known for frames < localKnown, remote ones for
+    // frames < remoteKnown
+    uint32_t localKnown = 0;
+    uint32_t remoteKnown = 0;
+    // the peer has our inputs for frames < peerAck
+    uint32_t peerAck = 0;
+    // earliest frame simulated with a wrong prediction
+    uint32_t rollbackTo = NONE;
+
+    // time sync, see update()
+    uint32_t remoteFrame = 0;
+    int remoteAdvantage = 0;
+
+    uint32_t peerHashFrame = NONE;
+    uint32_t peerHash = 0;
+    bool desynced = false;
+    bool mismatchLogged = false;
+
+    std::list<Outgoing> outgoing;
+    std::minstd_rand lossRng{std::random_device{}()};
+
+    // for the log at the end of the session
+    uint64_t rollbacks = 0;
+    uint64_t resimulated = 0;
+    int maxRollback = 0;
+    uint64_t stalls = 0;
+};
+
+#endif
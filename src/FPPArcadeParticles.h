@@ -0,0 +1,78 @@
+#ifndef __FPPARCADE_PARTICLES__
+#define __FPPARCADE_PARTICLES__
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <random>
+
+class FPPArcadeCanvas;
+
+// Short lived sparks for game events.  Storage is a fixed set of arrays,
+// one per field, with the live particles packed at the front, so spawning
+// never allocates and stepping and drawing only touch the live ones.  A
+// particle that dies is replaced by the last live one.
+//
+// Particles are drawn over the picture only while it is presented and are
+// then taken off again, so games that redraw only now and then (Tetris)
+// don't have to know about them.  They are pure decoration and are not
+// part of a snapshot.
+class FPPArcadeParticles {
+public:
+    static constexpr int CAPACITY = 256;
+    static constexpr int LEVELS = 4;
+
+    FPPArcadeParticles();
+
+    // count sparks from x,y (canvas pixels) in random directions at up to
+    // speed pixels a second, fading out over lifeMS.  gravity is pixels a
+    // second squared, downwards.  Once CAPACITY are alive the rest of the
+    // burst is dropped.
+    void burst(float x, float y, int count, int r, int g, int b,
+               float speed, int lifeMS, float gravity = 0);
+    int size() const { return count; }
+    void clear();
+
+    // move everything on by ms and drop the ones that burned out
+    void step(int ms);
+
+    // Add the particles to the canvas' pixels, brighter while they are
+    // young, remembering the pixels they cover.  undraw() puts those back.
+    // The blended colors are snapped to a fixed cube of LEVELS shades a
+    // channel, so particles never take more than LEVELS^3 palette entries
+    // however many different shades they blend to.
+    void draw(FPPArcadeCanvas *c);
+    void undraw(FPPArcadeCanvas *c);
+
+private:
+    std::mutex lock;
+    int count = 0;
+
+    std::array<float, CAPACITY> x;
+    std::array<float, CAPACITY> y;
+    std::array<float, CAPACITY> vx;
+    std::array<float, CAPACITY> vy;
+    std::array<float, CAPACITY> gravity;
+    std::array<uint16_t, CAPACITY> age;
+    std::array<uint16_t, CAPACITY> life;
+    std::array<uint8_t, CAPACITY> r;
+    std::array<uint8_t, CAPACITY> g;
+    std::array<uint8_t, CAPACITY> b;
+
+    // what draw() overwrote, buffer offset and old palette index
+    std::array<uint32_t, CAPACITY> coveredAt;
+    std::array<uint8_t, CAPACITY> coveredIdx;
+    int covered = 0;
+
+    // palette index of each shade in the cube, asked of the canvas the
+    // first time it is used
+    uint8_t shade(FPPArcadeCanvas *c, int r, int g, int b);
+    FPPArcadeCanvas *rampCanvas = nullptr;
+    std::array<uint8_t, LEVELS * LEVELS * LEVELS> ramp{};
+    // the color ramp[n] had when it was looked up
+    std::array<uint32_t, LEVELS * LEVELS * LEVELS> rampColor;
+
+    std::minstd_rand rng{std::random_device{}()};
+};
+
+#endif
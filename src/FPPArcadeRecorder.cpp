@@ -0,0 +1,121 @@
+#include <fpp-pch.h>
+
+#include <chrono>
+#include <cstring>
+
+#include "FPPArcadeRecorder.h"
+
+#include "common.h"
+#include "log.h"
+#include "fseq/FSEQFile.h"
+
+FPPArcadeRecorder::FPPArcadeRecorder(const std::string &fn, uint32_t start, uint32_t count, int step, int maxMinutes) :
+    filename(fn), startChannel(start), channelCount(count), stepMS(step) {
+    maxFrames = maxMinutes * 60 * 1000 / stepMS;
+    for (auto &s : ring) {
+        s.data.resize(channelCount);
+    }
+}
+
+FPPArcadeRecorder::~FPPArcadeRecorder() {
+    stop();
+}
+
+bool FPPArcadeRecorder::start() {
+    file = FSEQFile::createFSEQFile(filename, 2, FSEQFile::CompressionType::zstd);
+    if (file == nullptr) {
+        LogErr(VB_PLUGIN, "FPP Arcade: could not create sequence %s\n", filename.c_str());
+        return false;
+    }
+    // The header has to be written before the first frame, so it claims the
+    // maximum length and is corrected in stop().
+    file->m_seqNumFrames = maxFrames;
+    file->m_seqChannelCount = channelCount;
+    file->m_seqStepTime = stepMS;
+    V2FSEQFile *v2 = dynamic_cast<V2FSEQFile*>(file);
+    if (v2) {
+        v2->m_sparseRanges.push_back({startChannel, channelCount});
+    }
+    file->writeHeader();
+    // addFrame() takes a full channel buffer and picks out the sparse range
+    frame.resize(startChannel + channelCount);
+    thread = std::thread([this]() { run(); });
+    return true;
+}
+
+void FPPArcadeRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> l(lock);
+        stopping = true;
+    }
+    ready.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (file) {
+        file->m_seqNumFrames = nextFrame;
+        file->finalize();
+        delete file;
+        file = nullptr;
+        LogInfo(VB_PLUGIN, "FPP Arcade: recorded %u frames to %s, %llu dropped\n",
+                (uint32_t)nextFrame, filename.c_str(), (unsigned long long)dropped);
+    }
+}
+
+void FPPArcadeRecorder::capture(const uint8_t *seqData) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        dropped++;
+        return;
+    }
+    Slot &s = ring[h % RING_SIZE];
+    s.time = GetTimeMS();
+    memcpy(s.data.data(), seqData + startChannel, channelCount);
+    head.store(h + 1, std::memory_order_release);
+    // no lock here, the writer also polls so a missed wakeup only delays it
+    ready.notify_one();
+}
+
+void FPPArcadeRecorder::run() {
+    std::unique_lock<std::mutex> l(lock);
+    while (true) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t != head.load(std::memory_order_acquire)) {
+            l.unlock();
+            write(ring[t % RING_SIZE]);
+            tail.store(t + 1, std::memory_order_release);
+            l.lock();
+            continue;
+        }
+        if (stopping) {
+            return;
+        }
+        ready.wait_for(l, std::chrono::milliseconds(10));
+    }
+}
+
+void FPPArcadeRecorder::write(const Slot &slot) {
+    if (nextFrame >= maxFrames) {
+        return;
+    }
+    if (nextFrame == 0) {
+        startTime = slot.time;
+    }
+    // Output frames don't line up with the sequence steps, place each one
+    // at the step nearest its capture time.  Gaps repeat the previous frame
+    // and a second capture within a step is ignored.
+    uint32_t f = (slot.time - startTime + stepMS / 2) / stepMS;
+    if (f < nextFrame) {
+        return;
+    }
+    while (nextFrame < f && nextFrame < maxFrames) {
+        file->addFrame(nextFrame, frame.data());
+        nextFrame++;
+    }
+    if (nextFrame >= maxFrames) {
+        return;
+    }
+    memcpy(&frame[startChannel], slot.data.data(), channelCount);
+    file->addFrame(nextFrame, frame.data());
+    nextFrame++;
+}
@@ -0,0 +1,73 @@
+#ifndef __FPPARCADE_RECORDER__
+#define __FPPARCADE_RECORDER__
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FSEQFile;
+
+// Records a model's channel range, as it is output, into a compressed v2
+// FSEQ so a game session can be played back as a regular sequence.
+// capture() runs on the channel output thread and only copies into a fixed
+// ring of frame buffers; a writer thread does the compression and file IO.
+// If the writer falls behind, frames are dropped rather than ever making
+// the output thread wait.
+class FPPArcadeRecorder {
+public:
+    FPPArcadeRecorder(const std::string &filename, uint32_t startChannel, uint32_t channelCount,
+                      int stepMS, int maxMinutes);
+    ~FPPArcadeRecorder();
+
+    bool start();
+    // drains the ring and finalizes the file
+    void stop();
+
+    void capture(const uint8_t *seqData);
+
+    const std::string &getFilename() const { return filename; }
+    uint32_t getFramesWritten() const { return nextFrame; }
+    uint64_t getFramesDropped() const { return dropped; }
+
+private:
+    static constexpr uint32_t RING_SIZE = 64;
+
+    class Slot {
+    public:
+        uint64_t time = 0;
+        std::vector<uint8_t> data;
+    };
+
+    void run();
+    void write(const Slot &slot);
+
+    std::string filename;
+    uint32_t startChannel;
+    uint32_t channelCount;
+    int stepMS;
+    uint32_t maxFrames;
+
+    std::array<Slot, RING_SIZE> ring;
+    // head is only written by capture(), tail only by the writer thread
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex lock;
+    std::condition_variable ready;
+    bool stopping = false;
+    std::thread thread;
+
+    // writer thread only
+    FSEQFile *file = nullptr;
+    std::vector<uint8_t> frame;
+    uint64_t startTime = 0;
+    std::atomic<uint32_t> nextFrame{0};
+};
+
+#endif
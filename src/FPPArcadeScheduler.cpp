@@ -0,0 +1,209 @@
+#include <fpp-pch.h>
+
+#include <chrono>
+
+#include "FPPArcade.h"
+#include "FPPArcadeScheduler.h"
+#include "FPPArcadeTrace.h"
+
+FPPArcadeScheduler FPPArcadeScheduler::INSTANCE;
+
+static thread_local bool tlsInFrame = false;
+static thread_local bool tlsInPoolJob = false;
+
+// effects due within this window of each other are ticked in the same frame
+static constexpr uint64_t FRAME_SLACK_US = 2000;
+
+static uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FPPArcadeWorkerPool::~FPPArcadeWorkerPool() {
+    stopThreads();
+}
+
+void FPPArcadeWorkerPool::setThreadCount(int n) {
+    std::lock_guard<std::mutex> jl(jobLock);
+    if (n == threads.size()) {
+        return;
+    }
+    stopThreads();
+    stopping = false;
+    for (int x = 0; x < n; x++) {
+        threads.emplace_back([this]() { worker(); });
+    }
+    threadCount = n;
+}
+
+void FPPArcadeWorkerPool::stopThreads() {
+    {
+        std::lock_guard<std::mutex> l(lock);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto &t : threads) {
+        t.join();
+    }
+    threads.clear();
+    threadCount = 0;
+}
+
+void FPPArcadeWorkerPool::runJob() {
+    tlsInPoolJob = true;
+    int i;
+    while ((i = jobNext.fetch_add(1)) < jobCount) {
+        (*jobFn)(i);
+    }
+    tlsInPoolJob = false;
+}
+
+void FPPArcadeWorkerPool::worker() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> l(lock);
+    while (true) {
+        jobReady.wait(l, [&]() { return stopping || jobGeneration != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = jobGeneration;
+        jobActive++;
+        l.unlock();
+        runJob();
+        l.lock();
+        if (--jobActive == 0) {
+            jobDone.notify_all();
+        }
+    }
+}
+
+void FPPArcadeWorkerPool::parallelFor(int count, const std::function<void(int)> &fn) {
+    if (count <= 0) {
+        return;
+    }
+    // Nested calls (a job that itself wants to go parallel) run inline
+    // rather than deadlocking on the busy pool.
+    if (threadCount == 0 || count == 1 || tlsInPoolJob) {
+        for (int x = 0; x < count; x++) {
+            fn(x);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> jl(jobLock);
+    {
+        std::lock_guard<std::mutex> l(lock);
+        jobFn = &fn;
+        jobCount = count;
+        jobNext = 0;
+        jobGeneration++;
+    }
+    jobReady.notify_all();
+    runJob();
+    std::unique_lock<std::mutex> l(lock);
+    // workers that woke up late find no indices left and finish immediately
+    jobDone.wait(l, [&]() { return jobActive == 0; });
+    jobFn = nullptr;
+}
+
+bool FPPArcadeScheduler::inFrame() {
+    return tlsInFrame;
+}
+
+void FPPArcadeScheduler::setWorkerCount(int n) {
+    if (n < 0) {
+        n = 0;
+    }
+    if (n == 0) {
+        // effects already on the scheduler finish there, new ones go to FPP
+        enabled = false;
+        return;
+    }
+    // the scheduler thread itself does a share of the work
+    workers.setThreadCount(n - 1);
+    enabled = true;
+    std::lock_guard<std::mutex> l(lock);
+    if (!thread.joinable()) {
+        stopping = false;
+        thread = std::thread([this]() { run(); });
+    }
+}
+
+void FPPArcadeScheduler::shutdown() {
+    enabled = false;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    workers.setThreadCount(0);
+}
+
+void FPPArcadeScheduler::add(FPPArcadeGameEffect *e, int32_t firstUpdateMS) {
+    {
+        std::lock_guard<std::mutex> l(lock);
+        effects.push_back({e, nowMicros() + firstUpdateMS * 1000});
+    }
+    changed.notify_all();
+}
+
+void FPPArcadeScheduler::remove(FPPArcadeGameEffect *e) {
+    // blocks until any frame that is ticking the effect has finished
+    std::lock_guard<std::mutex> l(lock);
+    for (auto it = effects.begin(); it != effects.end(); ++it) {
+        if (it->effect == e) {
+            effects.erase(it);
+            return;
+        }
+    }
+}
+
+void FPPArcadeScheduler::run() {
+    std::vector<Entry*> due;
+    std::unique_lock<std::mutex> l(lock);
+    while (!stopping) {
+        if (effects.empty()) {
+            changed.wait(l);
+            continue;
+        }
+        uint64_t next = UINT64_MAX;
+        for (auto &e : effects) {
+            next = std::min(next, e.nextTick);
+        }
+        uint64_t now = nowMicros();
+        if (next > now) {
+            changed.wait_for(l, std::chrono::microseconds(next - now));
+            continue;
+        }
+
+        ARCADE_TRACE("scheduler frame");
+        due.clear();
+        for (auto &e : effects) {
+            if (e.nextTick <= now + FRAME_SLACK_US) {
+                due.push_back(&e);
+            }
+        }
+        // The lock stays held for the whole frame so an effect being deleted
+        // on another thread waits in remove() until we're done with it.
+        workers.parallelFor(due.size(), [&due](int i) {
+            Entry *e = due[i];
+            tlsInFrame = true;
+            int32_t r = e->effect->tick();
+            tlsInFrame = false;
+            if (r > 0) {
+                e->nextTick = nowMicros() + r * 1000;
+            } else {
+                e->effect->finishScheduled(r);
+                e->nextTick = UINT64_MAX;
+            }
+        });
+        {
+            ARCADE_TRACE("batch present");
+            for (auto e : due) {
+                e->effect->flushPresent();
+            }
+        }
+        effects.remove_if([](const Entry &e) { return e.nextTick == UINT64_MAX; });
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef __FPPARCADE_SCHEDULER__
+#define __FPPARCADE_SCHEDULER__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class FPPArcadeGameEffect;
+
+// Fixed set of threads for data-parallel work.  parallelFor() hands out
+// indices through an atomic counter and the calling thread helps, so a pool
+// with zero threads just runs everything on the caller.
+class FPPArcadeWorkerPool {
+public:
+    FPPArcadeWorkerPool() {}
+    ~FPPArcadeWorkerPool();
+
+    void setThreadCount(int n);
+    int getThreadCount() const { return threadCount; }
+
+    void parallelFor(int count, const std::function<void(int)> &fn);
+
+private:
+    void stopThreads();
+    void worker();
+    void runJob();
+
+    std::vector<std::thread> threads;
+    std::atomic<int> threadCount{0};
+    std::mutex lock;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    // only one parallelFor at a time
+    std::mutex jobLock;
+
+    std::atomic<const std::function<void(int)>*> jobFn{nullptr};
+    std::atomic<int> jobCount{0};
+    std::atomic<int> jobNext{0};
+    int jobActive = 0;
+    uint64_t jobGeneration = 0;
+    bool stopping = false;
+};
+
+// Drives every active FPPArcadeGameEffect from one thread instead of FPP's
+// per-model effect scheduling.  Each frame, the effects whose tick is due
+// run updateGame() in parallel on the worker pool, then all of the
+// presents they requested are flushed together.  With no worker threads
+// configured the scheduler is off and effects run from FPP as before.
+class FPPArcadeScheduler {
+public:
+    static FPPArcadeScheduler INSTANCE;
+
+    void setWorkerCount(int n);
+    bool isEnabled() const { return enabled; }
+    void shutdown();
+
+    void add(FPPArcadeGameEffect *e, int32_t firstUpdateMS);
+    void remove(FPPArcadeGameEffect *e);
+
+    FPPArcadeWorkerPool &getWorkers() { return workers; }
+
+    // true on the scheduler/worker threads while a frame is being ticked
+    static bool inFrame();
+
+private:
+    class Entry {
+    public:
+        FPPArcadeGameEffect *effect;
+        uint64_t nextTick;
+    };
+
+    void run();
+
+    std::atomic<bool> enabled{false};
+    FPPArcadeWorkerPool workers;
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::list<Entry> effects;
+    std::thread thread;
+    bool stopping = false;
+};
+
+#endif
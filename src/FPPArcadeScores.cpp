@@ -0,0 +1,286 @@
+#include <fpp-pch.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <libgen.h>
+#include <unistd.h>
+
+#include "FPPArcadeScores.h"
+
+#include "common.h"
+#include "log.h"
+#include "settings.h"
+
+FPPArcadeScores FPPArcadeScores::INSTANCE;
+
+// rewrite the log once it is this many lines and mostly superseded scores
+static constexpr int COMPACT_LINES = 500;
+
+// model and game names end up in a tab separated line
+static std::string clean(const std::string &s) {
+    std::string r = s;
+    for (auto &ch : r) {
+        if (ch == '\t' || ch == '\n' || ch == '\r') {
+            ch = ' ';
+        }
+    }
+    return r;
+}
+
+void FPPArcadeScores::start() {
+    filename = FPP_DIR_CONFIG("/plugin.fpp-arcade-scores.log");
+    startTime = time(nullptr);
+    load();
+    std::lock_guard<std::mutex> l(queueLock);
+    if (!thread.joinable()) {
+        stopping = false;
+        thread = std::thread([this]() { run(); });
+    }
+}
+
+void FPPArcadeScores::stop() {
+    {
+        std::lock_guard<std::mutex> l(queueLock);
+        stopping = true;
+    }
+    queued.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void FPPArcadeScores::load() {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        return;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::lock_guard<std::mutex> l(lock);
+    tables.clear();
+    logLines = 0;
+    int bad = 0;
+    size_t pos = 0;
+    while (true) {
+        size_t end = data.find('\n', pos);
+        if (end == std::string::npos) {
+            if (pos < data.size()) {
+                // a torn last write, cut it off so the next append starts
+                // on a line of its own
+                bad++;
+                if (truncate(filename.c_str(), pos) != 0) {
+                    LogWarn(VB_PLUGIN, "FPP Arcade: could not truncate %s: %s\n", filename.c_str(), strerror(errno));
+                }
+            }
+            break;
+        }
+        std::vector<std::string> f;
+        size_t s = pos;
+        while (s <= end) {
+            size_t t = data.find('\t', s);
+            if (t == std::string::npos || t > end) {
+                t = end;
+            }
+            f.push_back(data.substr(s, t - s));
+            s = t + 1;
+        }
+        pos = end + 1;
+        logLines++;
+        if (f.size() != 5) {
+            bad++;
+            continue;
+        }
+        Entry e;
+        e.time = atoll(f[0].c_str());
+        e.score = atoi(f[3].c_str());
+        e.initials = f[4];
+        insert({f[1], f[2]}, e);
+    }
+    generation++;
+    if (bad) {
+        LogWarn(VB_PLUGIN, "FPP Arcade: skipped %d damaged lines in %s\n", bad, filename.c_str());
+    }
+    LogInfo(VB_PLUGIN, "FPP Arcade: loaded %d high score tables\n", (int)tables.size());
+}
+
+bool FPPArcadeScores::insert(const Key &key, const Entry &e) {
+    auto &t = tables[key];
+    // later scores go after earlier equal ones
+    auto it = std::upper_bound(t.begin(), t.end(), e, [](const Entry &a, const Entry &b) {
+        return a.score > b.score;
+    });
+    if (it - t.begin() >= TABLE_SIZE) {
+        return false;
+    }
+    t.insert(it, e);
+    if (t.size() > TABLE_SIZE) {
+        t.pop_back();
+    }
+    return true;
+}
+
+bool FPPArcadeScores::qualifies(const std::string &model, const std::string &game, int score) {
+    if (score <= 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> l(lock);
+    auto f = tables.find({model, game});
+    if (f == tables.end() || f->second.size() < TABLE_SIZE) {
+        return true;
+    }
+    return score > f->second.back().score;
+}
+
+void FPPArcadeScores::submit(const std::string &model, const std::string &game, int score, const std::string &initials) {
+    if (score <= 0) {
+        return;
+    }
+    Record r;
+    r.key = {clean(model), clean(game)};
+    r.entry.score = score;
+    r.entry.initials = clean(initials);
+    r.entry.time = time(nullptr);
+    {
+        // queued while still holding lock, so compact() sees a score
+        // either in the tables and the queue or in neither
+        std::lock_guard<std::mutex> l(lock);
+        if (!insert(r.key, r.entry)) {
+            return;
+        }
+        generation++;
+        std::lock_guard<std::mutex> q(queueLock);
+        queue.push_back(r);
+    }
+    queued.notify_all();
+}
+
+std::string FPPArcadeScores::toLine(const Key &key, const Entry &e) {
+    return std::to_string(e.time) + "\t" + key.first + "\t" + key.second + "\t" +
+           std::to_string(e.score) + "\t" + e.initials + "\n";
+}
+
+void FPPArcadeScores::run() {
+    std::vector<Record> records;
+    std::unique_lock<std::mutex> l(queueLock);
+    while (true) {
+        queued.wait(l, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+        records.swap(queue);
+        l.unlock();
+        append(records);
+        records.clear();
+        l.lock();
+    }
+}
+
+void FPPArcadeScores::append(const std::vector<Record> &records) {
+    std::string lines;
+    for (auto &r : records) {
+        lines += toLine(r.key, r.entry);
+    }
+    int fd = open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) {
+        LogErr(VB_PLUGIN, "FPP Arcade: could not open %s: %s\n", filename.c_str(), strerror(errno));
+        return;
+    }
+    // one write so the lines land together, then make sure they're on disk
+    if (write(fd, lines.data(), lines.size()) != (ssize_t)lines.size()) {
+        LogErr(VB_PLUGIN, "FPP Arcade: could not write %s: %s\n", filename.c_str(), strerror(errno));
+    }
+    fsync(fd);
+    close(fd);
+    logLines += records.size();
+
+    int kept = 0;
+    {
+        std::lock_guard<std::mutex> lk(lock);
+        for (auto &t : tables) {
+            kept += t.second.size();
+        }
+    }
+    if (logLines >= COMPACT_LINES && logLines > kept * 2) {
+        compact();
+    }
+}
+
+void FPPArcadeScores::compact() {
+    std::string lines;
+    int count = 0;
+    std::vector<Record> written;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        for (auto &t : tables) {
+            for (auto &e : t.second) {
+                lines += toLine(t.first, e);
+                count++;
+            }
+        }
+        // scores submitted since run() took its batch are already in the
+        // tables written here, appending them as well would log them twice
+        std::lock_guard<std::mutex> q(queueLock);
+        written.swap(queue);
+    }
+    // written and synced in full before it replaces the log, so there is
+    // always one complete file on disk
+    std::string tmp = filename + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        LogErr(VB_PLUGIN, "FPP Arcade: could not create %s: %s\n", tmp.c_str(), strerror(errno));
+        requeue(written);
+        return;
+    }
+    bool ok = write(fd, lines.data(), lines.size()) == (ssize_t)lines.size() && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmp.c_str(), filename.c_str()) != 0) {
+        LogErr(VB_PLUGIN, "FPP Arcade: could not compact %s: %s\n", filename.c_str(), strerror(errno));
+        unlink(tmp.c_str());
+        requeue(written);
+        return;
+    }
+    std::string dir = filename;
+    int dfd = open(dirname(&dir[0]), O_RDONLY);
+    if (dfd >= 0) {
+        fsync(dfd);
+        close(dfd);
+    }
+    LogDebug(VB_PLUGIN, "FPP Arcade: compacted %s from %d to %d lines\n", filename.c_str(), logLines, count);
+    logLines = count;
+}
+
+void FPPArcadeScores::requeue(std::vector<Record> &records) {
+    // still only in memory, they go ahead of anything queued since
+    std::lock_guard<std::mutex> q(queueLock);
+    queue.insert(queue.begin(), records.begin(), records.end());
+}
+
+void FPPArcadeScores::getJSON(std::string &j, std::string &e) {
+    std::lock_guard<std::mutex> l(lock);
+    if (jsonGeneration != generation) {
+        Json::Value root(Json::arrayValue);
+        for (auto &t : tables) {
+            Json::Value table;
+            table["model"] = t.first.first;
+            table["game"] = t.first.second;
+            table["scores"] = Json::Value(Json::arrayValue);
+            for (auto &s : t.second) {
+                Json::Value v;
+                v["score"] = s.score;
+                v["initials"] = s.initials;
+                v["time"] = (Json::Int64)s.time;
+                table["scores"].append(v);
+            }
+            root.append(table);
+        }
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        json = Json::writeString(writer, root);
+        // the start time keeps ETags from a previous run from matching
+        etag = "\"" + std::to_string(startTime) + "-" + std::to_string(generation) + "\"";
+        jsonGeneration = generation;
+    }
+    j = json;
+    e = etag;
+}
@@ -0,0 +1,83 @@
+#ifndef __FPPARCADE_SCORES__
+#define __FPPARCADE_SCORES__
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// High score tables, one per model and game.  Every submitted score is
+// appended to a log, one line each, by a writer thread so a game over
+// never waits on the SD card.  Only whole lines are read back, so a write
+// cut short by a power failure loses just that score.  Once the log holds
+// many more lines than the tables do it is rewritten with just the tables
+// and renamed over the old one.
+class FPPArcadeScores {
+public:
+    static FPPArcadeScores INSTANCE;
+    static constexpr int TABLE_SIZE = 10;
+
+    class Entry {
+    public:
+        int score = 0;
+        std::string initials;
+        int64_t time = 0;
+    };
+
+    // loads the log and starts the writer
+    void start();
+    // writes anything still queued
+    void stop();
+
+    // would the score make the model's table for the game
+    bool qualifies(const std::string &model, const std::string &game, int score);
+    void submit(const std::string &model, const std::string &game, int score, const std::string &initials);
+
+    // all of the tables as JSON, rebuilt only after a change, and the ETag
+    // that goes with it
+    void getJSON(std::string &json, std::string &etag);
+
+private:
+    typedef std::pair<std::string, std::string> Key;
+    class Record {
+    public:
+        Key key;
+        Entry entry;
+    };
+
+    void load();
+    // true if it made the table
+    bool insert(const Key &key, const Entry &e);
+    static std::string toLine(const Key &key, const Entry &e);
+    void run();
+    void append(const std::vector<Record> &records);
+    void compact();
+    // put back records compact() took off the queue but didn't write
+    void requeue(std::vector<Record> &records);
+
+    std::string filename;
+
+    std::mutex lock;
+    std::map<Key, std::vector<Entry>> tables;
+    uint64_t generation = 0;
+    uint64_t jsonGeneration = UINT64_MAX;
+    std::string json;
+    std::string etag;
+    int64_t startTime = 0;
+
+    // taken after lock when both are needed
+    std::mutex queueLock;
+    std::condition_variable queued;
+    std::vector<Record> queue;
+    bool stopping = false;
+    std::thread thread;
+
+    // writer thread only
+    int logLines = 0;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include <fpp-pch.h>
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FPPArcadeSharedFrame.h"
+
+#include "log.h"
+
+FPPArcadeSharedFrame::FPPArcadeSharedFrame(const std::string &model, int width, int height) {
+    name = "/fpp-arcade-";
+    for (auto ch : model) {
+        name += isalnum(ch) ? ch : '_';
+    }
+    size = sizeof(FPPArcadeSharedFrameHeader) + width * height * 3;
+
+    // always a fresh segment, a reader still mapping the last game's keeps it
+    shm_unlink(name.c_str());
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        LogWarn(VB_PLUGIN, "FPP Arcade: could not create shared memory %s: %s\n", name.c_str(), strerror(errno));
+        return;
+    }
+    void *p = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+        p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (p == MAP_FAILED) {
+        LogWarn(VB_PLUGIN, "FPP Arcade: could not map shared memory %s: %s\n", name.c_str(), strerror(errno));
+        close(fd);
+        fd = -1;
+        shm_unlink(name.c_str());
+        return;
+    }
+    header = new (p) FPPArcadeSharedFrameHeader();
+    memcpy(header->magic, "FPPARCD", 8);
+    header->version = 1;
+    header->headerSize = sizeof(FPPArcadeSharedFrameHeader);
+    header->width = width;
+    header->height = height;
+    header->sequence = 0;
+    header->frame = 0;
+    header->active.store(1, std::memory_order_release);
+}
+
+FPPArcadeSharedFrame::~FPPArcadeSharedFrame() {
+    if (header == nullptr) {
+        return;
+    }
+    header->active.store(0, std::memory_order_release);
+    munmap(header, size);
+
+    // A newer game on the same model may already have replaced the name,
+    // only remove it if it is still ours.
+    struct stat ours, current;
+    int cfd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (cfd >= 0) {
+        if (fstat(fd, &ours) == 0 && fstat(cfd, &current) == 0 && ours.st_ino == current.st_ino) {
+            shm_unlink(name.c_str());
+        }
+        close(cfd);
+    }
+    close(fd);
+}
+
+uint8_t *FPPArcadeSharedFrame::beginWrite() {
+    uint32_t s = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return reinterpret_cast<uint8_t*>(header) + sizeof(FPPArcadeSharedFrameHeader);
+}
+
+void FPPArcadeSharedFrame::endWrite() {
+    header->frame.fetch_add(1, std::memory_order_relaxed);
+    header->sequence.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,45 @@
+#ifndef __FPPARCADE_SHARED_FRAME__
+#define __FPPARCADE_SHARED_FRAME__
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Layout of the shared memory segment, for readers.  The RGB pixels
+// (width * height * 3, row major) follow the header.  sequence is a
+// seqlock: it is odd while a frame is being written, so a reader copies
+// the pixels between two reads of an even, unchanged sequence.
+struct FPPArcadeSharedFrameHeader {
+    char magic[8]; // "FPPARCD"
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t width;
+    uint32_t height;
+    std::atomic<uint32_t> sequence;
+    // 0 once the game has ended
+    std::atomic<uint32_t> active;
+    std::atomic<uint64_t> frame;
+};
+
+// Publishes a game's picture to the POSIX shared memory segment
+// /fpp-arcade-<model> for previews and other local tools.  Writing never
+// waits on readers.
+class FPPArcadeSharedFrame {
+public:
+    FPPArcadeSharedFrame(const std::string &model, int width, int height);
+    ~FPPArcadeSharedFrame();
+
+    bool isValid() const { return header != nullptr; }
+
+    // returns the pixel area to fill, must be followed by endWrite()
+    uint8_t *beginWrite();
+    void endWrite();
+
+private:
+    std::string name;
+    int fd = -1;
+    size_t size = 0;
+    FPPArcadeSharedFrameHeader *header = nullptr;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef __FPPARCADE_SNAPSHOT__
+#define __FPPARCADE_SNAPSHOT__
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Compact binary image of a game session, so a session can be put aside
+// and carried on later from the exact frame it was on.
+//
+// The same serialize() function both saves and loads: io() appends the
+// value when saving and overwrites it from the image when loading, so the
+// two directions can't drift apart.  Plain data is copied as raw bytes,
+// classes that aren't trivially copyable provide their own
+// serialize(FPPArcadeSnapshot &).  Images are host byte order and never
+// leave the process.
+class FPPArcadeSnapshot {
+public:
+    // empty, for saving
+    FPPArcadeSnapshot() {}
+    // reads d, which must outlive the snapshot
+    FPPArcadeSnapshot(const std::vector<uint8_t> &d) : in(&d) {}
+
+    bool isLoading() const { return in != nullptr; }
+    // false once a load ran off the end of the image or hit a size that
+    // doesn't match, everything after that is left alone
+    bool isValid() const { return ok; }
+    void fail() { ok = false; }
+
+    std::vector<uint8_t> &getData() { return out; }
+
+    void bytes(void *p, size_t n) {
+        if (!in) {
+            const uint8_t *b = static_cast<const uint8_t*>(p);
+            out.insert(out.end(), b, b + n);
+            return;
+        }
+        if (!ok || n > in->size() - pos) {
+            ok = false;
+            return;
+        }
+        memcpy(p, in->data() + pos, n);
+        pos += n;
+    }
+
+    template<class T>
+    void io(T &v) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            bytes(&v, sizeof(T));
+        } else {
+            v.serialize(*this);
+        }
+    }
+    template<class A, class B>
+    void io(std::pair<A, B> &v) {
+        io(v.first);
+        io(v.second);
+    }
+    void io(std::string &v) {
+        uint32_t n = v.size();
+        io(n);
+        if (in) {
+            if (!ok || n > in->size() - pos) {
+                ok = false;
+                return;
+            }
+            v.resize(n);
+        }
+        bytes(&v[0], n);
+    }
+    template<class T>
+    void io(std::vector<T> &v) {
+        uint32_t n = v.size();
+        io(n);
+        if (in) {
+            // every element takes at least a byte, so a corrupt count
+            // can't make us allocate more than the image could hold
+            if (!ok || n > in->size() - pos) {
+                ok = false;
+                return;
+            }
+            v.resize(n);
+        }
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            bytes(v.data(), n * sizeof(T));
+        } else {
+            for (auto &e : v) {
+                io(e);
+            }
+        }
+    }
+    template<class T>
+    void io(std::list<T> &v) {
+        uint32_t n = v.size();
+        io(n);
+        if (in) {
+            if (!ok || n > in->size() - pos) {
+                ok = false;
+                return;
+            }
+            v.resize(n);
+        }
+        for (auto &e : v) {
+            io(e);
+        }
+    }
+    // For containers the effect built itself whose elements can't be
+    // default constructed (sprites need their frames).  Loading only
+    // overwrites them and fails if the count differs.
+    template<class T>
+    void ioEach(std::vector<T> &v) {
+        uint32_t n = v.size();
+        io(n);
+        if (n != v.size()) {
+            ok = false;
+            return;
+        }
+        for (auto &e : v) {
+            io(e);
+        }
+    }
+
+private:
+    std::vector<uint8_t> out;
+    const std::vector<uint8_t> *in = nullptr;
+    size_t pos = 0;
+    bool ok = true;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include <fpp-pch.h>
+
+#include "FPPArcade.h"
+#include "FPPArcadeSprite.h"
+
+FPPArcadeSpriteFrame::FPPArcadeSpriteFrame(const std::vector<std::string> &art, uint8_t c) {
+    height = art.size();
+    for (auto &r : art) {
+        width = std::max(width, (int)r.size());
+    }
+    width = std::min(width, 64);
+    masks.resize(height);
+    pixels.resize(width * height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width && x < art[y].size(); x++) {
+            if (art[y][x] != '.' && art[y][x] != ' ') {
+                masks[y] |= 1ULL << x;
+                pixels[y * width + x] = c;
+            }
+        }
+    }
+}
+
+bool FPPArcadeSpriteFrame::isEmpty() const {
+    for (auto m : masks) {
+        if (m) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FPPArcadeSpriteFrame::erase(int cx, int cy, int radius) {
+    bool any = false;
+    for (int y = std::max(0, cy - radius); y <= std::min(height - 1, cy + radius); y++) {
+        for (int x = std::max(0, cx - radius); x <= std::min(width - 1, cx + radius); x++) {
+            if (masks[y] & (1ULL << x)) {
+                masks[y] &= ~(1ULL << x);
+                pixels[y * width + x] = 0;
+                any = true;
+            }
+        }
+    }
+    return any;
+}
+
+void FPPArcadeSpriteFrame::clearBits(int y, uint64_t bits) {
+    bits &= masks[y];
+    masks[y] &= ~bits;
+    while (bits) {
+        int x = __builtin_ctzll(bits);
+        bits &= bits - 1;
+        pixels[y * width + x] = 0;
+    }
+}
+
+void FPPArcadeSpriteFrame::draw(FPPArcadeGameEffect *e, int px, int py) const {
+    for (int y = 0; y < height; y++) {
+        uint64_t m = masks[y];
+        while (m) {
+            int x = __builtin_ctzll(m);
+            m &= m - 1;
+            e->outputPixel(px + x, py + y, pixels[y * width + x]);
+        }
+    }
+}
+
+void FPPArcadeSpriteFrame::serialize(FPPArcadeSnapshot &s) {
+    int w = width;
+    int h = height;
+    s.io(w);
+    s.io(h);
+    if (w != width || h != height) {
+        s.fail();
+        return;
+    }
+    s.bytes(masks.data(), masks.size() * sizeof(uint64_t));
+    s.bytes(pixels.data(), pixels.size());
+}
+
+void FPPArcadeSprite::serialize(FPPArcadeSnapshot &s) {
+    s.io(x);
+    s.io(y);
+    s.io(active);
+    s.io(frame);
+    if (frame < 0 || frame >= frames.size()) {
+        frame = 0;
+        s.fail();
+    }
+}
+
+FPPArcadeSpriteFrame &FPPArcadeSprite::makeUnique() {
+    if (frames[frame].use_count() > 1) {
+        frames[frame] = std::make_shared<FPPArcadeSpriteFrame>(*frames[frame]);
+    }
+    return *frames[frame];
+}
+
+void FPPArcadeSprite::draw(FPPArcadeGameEffect *e) const {
+    if (active) {
+        current().draw(e, x, y);
+    }
+}
+
+bool FPPArcadeSprite::collides(const FPPArcadeSprite &o) const {
+    if (!active || !o.active) {
+        return false;
+    }
+    const FPPArcadeSpriteFrame &a = current();
+    const FPPArcadeSpriteFrame &b = o.current();
+    if (x >= o.x + b.getWidth() || o.x >= x + a.getWidth() ||
+        y >= o.y + b.getHeight() || o.y >= y + a.getHeight()) {
+        return false;
+    }
+    // line the masks up on the columns they share
+    int dx = o.x - x;
+    int top = std::max(y, o.y);
+    int bottom = std::min(y + a.getHeight(), o.y + b.getHeight());
+    for (int row = top; row < bottom; row++) {
+        uint64_t ma = a.getMask(row - y);
+        uint64_t mb = b.getMask(row - o.y);
+        if (dx >= 0 ? ((ma >> dx) & mb) : (ma & (mb >> -dx))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FPPArcadeSprite::erode(const FPPArcadeSprite &o) {
+    if (!collides(o)) {
+        return false;
+    }
+    FPPArcadeSpriteFrame &a = makeUnique();
+    const FPPArcadeSpriteFrame &b = o.current();
+    int dx = o.x - x;
+    int top = std::max(y, o.y);
+    int bottom = std::min(y + a.getHeight(), o.y + b.getHeight());
+    for (int row = top; row < bottom; row++) {
+        uint64_t mb = b.getMask(row - o.y);
+        a.clearBits(row - y, dx >= 0 ? (mb << dx) : (mb >> -dx));
+    }
+    return true;
+}
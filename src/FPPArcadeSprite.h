@@ -0,0 +1,148 @@
+#ifndef __FPPARCADE_SPRITE__
+#define __FPPARCADE_SPRITE__
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FPPArcadeSnapshot.h"
+
+class FPPArcadeGameEffect;
+
+// One pre-rasterized image of a sprite, at most 64 pixels wide.  Besides the
+// palette index of every pixel it keeps a bitmask per row (bit x set where
+// the pixel is solid) so collisions are tested a row at a time with a
+// shift and an AND.
+class FPPArcadeSpriteFrame {
+public:
+    // rows of text, '.' or ' ' is transparent, anything else is drawn in c
+    FPPArcadeSpriteFrame(const std::vector<std::string> &art, uint8_t c);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    uint64_t getMask(int y) const { return masks[y]; }
+    bool isEmpty() const;
+
+    // clear the solid pixels within radius of x,y (frame coordinates),
+    // returns true if any were cleared
+    bool erase(int x, int y, int radius);
+    // clear the given bits of row y
+    void clearBits(int y, uint64_t bits);
+
+    void draw(FPPArcadeGameEffect *e, int x, int y) const;
+
+    // the pixels, for frames that have been damaged
+    void serialize(FPPArcadeSnapshot &s);
+
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<uint64_t> masks;
+    std::vector<uint8_t> pixels;
+};
+
+class FPPArcadeSprite {
+public:
+    FPPArcadeSprite() {}
+    FPPArcadeSprite(const std::shared_ptr<FPPArcadeSpriteFrame> &f, int px = 0, int py = 0) : x(px), y(py) {
+        frames.push_back(f);
+    }
+
+    void addFrame(const std::shared_ptr<FPPArcadeSpriteFrame> &f) { frames.push_back(f); }
+    void setFrame(int f) { frame = f % frames.size(); }
+    int getFrame() const { return frame; }
+    const FPPArcadeSpriteFrame &current() const { return *frames[frame]; }
+    // a private copy of the current frame, for sprites that get damaged
+    FPPArcadeSpriteFrame &makeUnique();
+
+    int getWidth() const { return current().getWidth(); }
+    int getHeight() const { return current().getHeight(); }
+
+    void draw(FPPArcadeGameEffect *e) const;
+
+    // bounding boxes first, then the masks of the overlapping rows
+    bool collides(const FPPArcadeSprite &o) const;
+    // clear our pixels that o covers (damaged shields), true if any were
+    bool erode(const FPPArcadeSprite &o);
+
+    // position and state, the frames are left to whoever built the sprite
+    void serialize(FPPArcadeSnapshot &s);
+
+    int x = 0;
+    int y = 0;
+    bool active = true;
+
+private:
+    std::vector<std::shared_ptr<FPPArcadeSpriteFrame>> frames;
+    int frame = 0;
+};
+
+// Fixed size pool for short lived objects like projectiles.  Objects are
+// reused in place, so firing never allocates.
+template<class T, int N>
+class FPPArcadePool {
+public:
+    FPPArcadePool() {
+        used.fill(false);
+    }
+    // every slot starts as a copy of proto, so acquire() only has to
+    // set the position
+    FPPArcadePool(const T &proto) {
+        items.fill(proto);
+        used.fill(false);
+    }
+
+    // nullptr when all N are in use
+    T *acquire() {
+        for (int x = 0; x < N; x++) {
+            int i = (next + x) % N;
+            if (!used[i]) {
+                used[i] = true;
+                next = (i + 1) % N;
+                count++;
+                return &items[i];
+            }
+        }
+        return nullptr;
+    }
+    void release(T *t) {
+        int i = t - &items[0];
+        if (used[i]) {
+            used[i] = false;
+            count--;
+        }
+    }
+    void clear() {
+        used.fill(false);
+        count = 0;
+    }
+    int size() const { return count; }
+
+    void serialize(FPPArcadeSnapshot &s) {
+        s.io(used);
+        s.io(next);
+        s.io(count);
+        for (auto &i : items) {
+            s.io(i);
+        }
+    }
+
+    template<class F>
+    void forEach(F &&f) {
+        for (int x = 0; x < N; x++) {
+            if (used[x]) {
+                f(items[x]);
+            }
+        }
+    }
+
+private:
+    std::array<T, N> items;
+    std::array<bool, N> used;
+    int next = 0;
+    int count = 0;
+};
+
+#endif
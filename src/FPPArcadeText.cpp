@@ -0,0 +1,190 @@
+#include <fpp-pch.h>
+
+#include <cctype>
+#include <map>
+
+#include "FPPArcadeCanvas.h"
+#include "FPPArcadeText.h"
+#include "FPPArcadeTrace.h"
+
+static const std::map<uint8_t, std::vector<uint8_t>> LETTERS = {
+    {'G', {1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1}},
+    {'A', {1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1}},
+    {'M', {1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1}},
+    {'E', {1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1}},
+    {'O', {1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1}},
+    {'V', {1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 0, 1, 0}},
+    {'R', {1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1}},
+
+    {'Y', {1, 0, 1, 1, 0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
+    {'U', {1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1}},
+    {'W', {1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1}},
+    {'I', {0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
+    {'N', {1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1}},
+    {'B', {1, 1, 0, 1, 0, 1, 1, 1, 0, 1, 0, 1, 1, 1, 0}},
+    {'C', {1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 1, 1}},
+    {'D', {1, 1, 0, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 0}},
+    {'F', {1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0}},
+    {'H', {1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1}},
+    {'J', {0, 0, 1, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 1, 1}},
+    {'K', {1, 0, 1, 1, 0, 1, 1, 1, 0, 1, 0, 1, 1, 0, 1}},
+    {'L', {1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 1, 1}},
+    {'P', {1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 0, 1, 0, 0}},
+    {'Q', {1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1}},
+    {'S', {1, 1, 1, 1, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 1}},
+    {'T', {1, 1, 1, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
+    {'X', {1, 0, 1, 1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 0, 1}},
+    {'Z', {1, 1, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 1, 1, 1}},
+
+    
+    {'0', {1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1}},
+    {'1', {0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0}},
+    {'2', {1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1}},
+    {'3', {1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1}},
+    {'4', {1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0, 1}},
+    {'5', {1, 1, 1, 1, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 1}},
+    {'6', {1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1}},
+    {'7', {1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1}},
+    {'8', {1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1}},
+    {'9', {1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0, 1}},
+
+    {':', {0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0}},
+    {'-', {0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0}},
+    {'_', {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1}},
+    {'.', {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0}}
+};
+
+// blank columns after every letter and the width of a space or a
+// character the font doesn't have
+static constexpr int LETTER_GAP = 1;
+static constexpr int SPACE_WIDTH = 2;
+
+const uint8_t *FPPArcadeText::glyph(char c) {
+    auto it = LETTERS.find(std::toupper((unsigned char)c));
+    return it == LETTERS.end() ? nullptr : it->second.data();
+}
+
+// the first and one past the last column the glyph uses
+static void glyphColumns(const uint8_t *g, int &left, int &right) {
+    left = FPPArcadeText::GLYPH_WIDTH;
+    right = 0;
+    for (int x = 0; x < FPPArcadeText::GLYPH_WIDTH; x++) {
+        for (int y = 0; y < FPPArcadeText::GLYPH_HEIGHT; y++) {
+            if (g[y * FPPArcadeText::GLYPH_WIDTH + x]) {
+                left = std::min(left, x);
+                right = x + 1;
+            }
+        }
+    }
+}
+
+int FPPArcadeText::measure(const std::string &s) {
+    int w = 0;
+    for (auto ch : s) {
+        if (w) {
+            w += LETTER_GAP;
+        }
+        const uint8_t *g = glyph(ch);
+        int left = 0;
+        int right = SPACE_WIDTH;
+        if (g) {
+            glyphColumns(g, left, right);
+        }
+        w += std::max(right - left, 0);
+    }
+    return w;
+}
+
+int FPPArcadeText::fitScale(const std::string &s, int width, int height, int maxScale) {
+    int w = std::max(measure(s), 1);
+    for (int scl = maxScale; scl > 1; scl--) {
+        if (w * scl <= width && GLYPH_HEIGHT * scl <= height) {
+            return scl;
+        }
+    }
+    return 1;
+}
+
+void FPPArcadeText::set(const std::string &s, uint8_t c, int scl) {
+    scl = std::max(scl, 1);
+    if (s == text && c == color && scl == scale) {
+        return;
+    }
+    text = s;
+    color = c;
+    scale = scl;
+    width = measure(s) * scl;
+    height = GLYPH_HEIGHT * scl;
+    strip.assign(width * height, 0);
+
+    int x = 0;
+    for (auto ch : s) {
+        if (x) {
+            x += LETTER_GAP * scl;
+        }
+        const uint8_t *g = glyph(ch);
+        if (g == nullptr) {
+            x += SPACE_WIDTH * scl;
+            continue;
+        }
+        int left;
+        int right;
+        glyphColumns(g, left, right);
+        for (int gx = left; gx < right; gx++) {
+            for (int gy = 0; gy < GLYPH_HEIGHT; gy++) {
+                if (!g[gy * GLYPH_WIDTH + gx]) {
+                    continue;
+                }
+                for (int sy = 0; sy < scl; sy++) {
+                    uint8_t *row = &strip[(gy * scl + sy) * width + x + (gx - left) * scl];
+                    std::fill(row, row + scl, c);
+                }
+            }
+        }
+        x += std::max(right - left, 0) * scl;
+    }
+}
+
+void FPPArcadeText::drawWindow(FPPArcadeCanvas *c, int x, int y, int sx, int w, int gap) const {
+    ARCADE_TRACE("text");
+    int period = width + gap;
+    if (period <= 0) {
+        return;
+    }
+    int cw = c->getWidth();
+    int ch = c->getHeight();
+    uint8_t *buf = c->getBuffer();
+    // only the columns that land on the canvas
+    int first = std::max(0, -x);
+    int last = std::min(w, cw - x);
+    int start = ((sx + first) % period + period) % period;
+    for (int row = 0; row < height; row++) {
+        int py = y + row;
+        if (py < 0 || py >= ch) {
+            continue;
+        }
+        const uint8_t *src = &strip[row * width];
+        uint8_t *dst = buf + py * cw;
+        int col = start;
+        for (int i = first; i < last; i++) {
+            if (col < width && src[col]) {
+                dst[x + i] = src[col];
+            }
+            if (++col == period) {
+                col = 0;
+            }
+        }
+    }
+}
+
+void FPPArcadeText::drawMarquee(FPPArcadeCanvas *c, int x, int y, int w, uint64_t ms, int speed) const {
+    if (width <= w) {
+        draw(c, x + (w - width) / 2, y);
+        return;
+    }
+    // a box's width of blank after the text, so it is gone before it
+    // comes round again
+    int period = width + w;
+    int offset = (ms * speed / 1000) % period;
+    drawWindow(c, x, y, offset + width, w, w);
+}
@@ -0,0 +1,58 @@
+#ifndef __FPPARCADE_TEXT__
+#define __FPPARCADE_TEXT__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class FPPArcadeCanvas;
+
+// A line of text in the 3x5 arcade font, rasterized once into a strip
+// bitmap at one size and color.  Drawing copies a window of the strip onto
+// the canvas, so a message costs the same every frame wherever it is and
+// scrolling only moves where the window starts.  Letters are only as wide
+// as their glyph (an I is one pixel) with a blank column between them.
+//
+// Everything here is in canvas pixels, not game cells.
+class FPPArcadeText {
+public:
+    static constexpr int GLYPH_WIDTH = 3;
+    static constexpr int GLYPH_HEIGHT = 5;
+
+    // the 15 pixels of c's glyph, row major, nullptr if the font doesn't
+    // have it.  Lower case letters use the upper case glyphs.
+    static const uint8_t *glyph(char c);
+    // width of s at scale 1
+    static int measure(const std::string &s);
+    // The largest scale, up to maxScale, at which s fits in width x
+    // height.  1 if it doesn't fit even at 1.
+    static int fitScale(const std::string &s, int width, int height, int maxScale = 8);
+
+    // Rasterizes s, unless it is already the cached text, color and scale.
+    void set(const std::string &s, uint8_t c, int scale = 1);
+    const std::string &getText() const { return text; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // the whole strip with its top left at x,y
+    void draw(FPPArcadeCanvas *c, int x, int y) const { drawWindow(c, x, y, 0, width); }
+    // w columns of the strip from column sx, as if it repeated with gap
+    // blank columns after each copy
+    void drawWindow(FPPArcadeCanvas *c, int x, int y, int sx, int w, int gap = 0) const;
+    // A w wide marquee at x,y.  Text that fits is centered and stays put,
+    // longer text comes in from the right and scrolls through at speed
+    // pixels a second.  The position follows ms, so there is nothing to
+    // step between frames.
+    void drawMarquee(FPPArcadeCanvas *c, int x, int y, int w, uint64_t ms, int speed = 20) const;
+
+private:
+    std::string text;
+    uint8_t color = 0;
+    int scale = 0;
+    int width = 0;
+    int height = 0;
+    // palette indexes, 0 is transparent
+    std::vector<uint8_t> strip;
+};
+
+#endif
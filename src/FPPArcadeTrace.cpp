@@ -0,0 +1,125 @@
+#include <fpp-pch.h>
+
+#include <array>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <pthread.h>
+
+#include "FPPArcadeTrace.h"
+
+std::atomic<bool> FPPArcadeTrace::enabled(false);
+
+namespace {
+struct TraceEvent {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Written only by its owning thread; read by toChromeJSON() once tracing
+// has been stopped.
+class ThreadTraceBuffer {
+public:
+    static constexpr uint32_t SIZE = 4096;
+
+    ThreadTraceBuffer(int i) : tid(i) {
+        char buf[64] = {0};
+        pthread_getname_np(pthread_self(), buf, sizeof(buf));
+        threadName = buf[0] ? buf : ("thread " + std::to_string(i));
+    }
+
+    int tid;
+    std::string threadName;
+    std::atomic<uint32_t> head{0};
+    std::array<TraceEvent, SIZE> events;
+};
+
+std::mutex gTraceBuffersLock;
+std::list<ThreadTraceBuffer> gTraceBuffers;
+std::atomic<uint64_t> gTraceStart(0);
+thread_local ThreadTraceBuffer *tlsTraceBuffer = nullptr;
+
+ThreadTraceBuffer *getThreadTraceBuffer() {
+    if (tlsTraceBuffer == nullptr) {
+        std::lock_guard<std::mutex> lock(gTraceBuffersLock);
+        gTraceBuffers.emplace_back(gTraceBuffers.size() + 1);
+        tlsTraceBuffer = &gTraceBuffers.back();
+    }
+    return tlsTraceBuffer;
+}
+
+void appendJSONString(std::string &out, const std::string &s) {
+    out += '"';
+    for (auto ch : s) {
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if ((unsigned char)ch < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", ch);
+            out += buf;
+        } else {
+            out += ch;
+        }
+    }
+    out += '"';
+}
+}
+
+uint64_t FPPArcadeTrace::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool FPPArcadeTrace::start() {
+    bool expected = false;
+    if (!enabled.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+    gTraceStart = now();
+    return true;
+}
+
+void FPPArcadeTrace::stop() {
+    enabled = false;
+}
+
+void FPPArcadeTrace::record(const char *name, uint64_t start, uint64_t end) {
+    ThreadTraceBuffer *b = getThreadTraceBuffer();
+    uint32_t h = b->head.load(std::memory_order_relaxed);
+    b->events[h % ThreadTraceBuffer::SIZE] = {name, start, end};
+    b->head.store(h + 1, std::memory_order_release);
+}
+
+std::string FPPArcadeTrace::toChromeJSON() {
+    uint64_t traceStart = gTraceStart;
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(gTraceBuffersLock);
+    for (auto &b : gTraceBuffers) {
+        uint32_t h = b.head.load(std::memory_order_acquire);
+        uint32_t count = std::min(h, ThreadTraceBuffer::SIZE);
+        bool named = false;
+        for (uint32_t i = h - count; i != h; i++) {
+            const TraceEvent &ev = b.events[i % ThreadTraceBuffer::SIZE];
+            if (ev.start < traceStart) {
+                continue;
+            }
+            if (!named) {
+                out += first ? "" : ",";
+                out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(b.tid) + ",\"args\":{\"name\":";
+                appendJSONString(out, b.threadName);
+                out += "}}";
+                first = false;
+                named = true;
+            }
+            out += ",{\"name\":";
+            appendJSONString(out, ev.name);
+            out += ",\"cat\":\"arcade\",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(b.tid);
+            out += ",\"ts\":" + std::to_string(ev.start - traceStart);
+            out += ",\"dur\":" + std::to_string(ev.end - ev.start) + "}";
+        }
+    }
+    out += "]}";
+    return out;
+}
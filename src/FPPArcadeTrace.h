@@ -0,0 +1,48 @@
+#ifndef __FPPARCADE_TRACE__
+#define __FPPARCADE_TRACE__
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Lightweight span tracing for the input -> update -> flush pipeline.
+// When tracing is off a span costs one relaxed atomic load.  When on, each
+// thread appends completed spans to its own fixed size ring buffer, so
+// recording never takes a lock.  Dump with FPPArcadeTrace::toChromeJSON()
+// and load the result in chrome://tracing or Perfetto.
+class FPPArcadeTrace {
+public:
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // returns false if a trace is already being captured
+    static bool start();
+    static void stop();
+
+    static uint64_t now();
+    static void record(const char *name, uint64_t start, uint64_t end);
+
+    // spans recorded since the last start() as Chrome Trace Event JSON
+    static std::string toChromeJSON();
+private:
+    static std::atomic<bool> enabled;
+};
+
+class FPPArcadeTraceScope {
+public:
+    FPPArcadeTraceScope(const char *n) : name(n), start(FPPArcadeTrace::isEnabled() ? FPPArcadeTrace::now() : 0) {}
+    ~FPPArcadeTraceScope() {
+        if (start && FPPArcadeTrace::isEnabled()) {
+            FPPArcadeTrace::record(name, start, FPPArcadeTrace::now());
+        }
+    }
+private:
+    const char *name;
+    uint64_t start;
+};
+
+#define ARCADE_TRACE_CONCAT2(a, b) a##b
+#define ARCADE_TRACE_CONCAT(a, b) ARCADE_TRACE_CONCAT2(a, b)
+// name must be a string literal (or otherwise outlive the trace buffer)
+#define ARCADE_TRACE(name) FPPArcadeTraceScope ARCADE_TRACE_CONCAT(__arcadeTrace, __LINE__)(name)
+
+#endif
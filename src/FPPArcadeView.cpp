@@ -0,0 +1,262 @@
+#include <fpp-pch.h>
+
+#include <drogon/HttpAppFramework.h>
+
+#include "FPPArcadeView.h"
+
+#include "common.h"
+#include "log.h"
+
+FPPArcadeView FPPArcadeView::INSTANCE;
+
+// never more than this many frames a second to one viewer
+static constexpr uint64_t MIN_SEND_INTERVAL_US = 1000000 / 30;
+static constexpr uint64_t KEYFRAME_INTERVAL_US = 2000000;
+// no ack by then and the frame is assumed lost, start over with a keyframe
+static constexpr uint64_t ACK_TIMEOUT_US = 3000000;
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+class FPPArcadeViewController : public drogon::WebSocketController<FPPArcadeViewController, false> {
+public:
+    virtual void handleNewMessage(const WebSocketConnectionPtr &conn, std::string &&message, const WebSocketMessageType &type) override {
+        if (type == WebSocketMessageType::Text && message == "ack") {
+            FPPArcadeView::INSTANCE.ack(conn);
+        }
+    }
+    virtual void handleNewConnection(const HttpRequestPtr &req, const WebSocketConnectionPtr &conn) override {
+        static const std::string PREFIX = "/arcade/view/";
+        std::string path = req->path();
+        std::string model;
+        for (size_t x = PREFIX.size(); x < path.size(); x++) {
+            // a '%' that isn't followed by two hex digits is taken literally
+            int hi = x + 2 < path.size() ? hexDigit(path[x + 1]) : -1;
+            int lo = x + 2 < path.size() ? hexDigit(path[x + 2]) : -1;
+            if (path[x] == '%' && hi >= 0 && lo >= 0) {
+                model += (char)(hi * 16 + lo);
+                x += 2;
+            } else {
+                model += path[x];
+            }
+        }
+        FPPArcadeView::INSTANCE.addViewer(model, conn);
+    }
+    virtual void handleConnectionClosed(const WebSocketConnectionPtr &conn) override {
+        FPPArcadeView::INSTANCE.removeViewer(conn);
+    }
+
+    WS_PATH_LIST_BEGIN
+    WS_ADD_PATH_VIA_REGEX("/arcade/view/.+");
+    WS_PATH_LIST_END
+};
+
+static void appendVarint(std::string &out, uint32_t v) {
+    while (v >= 0x80) {
+        out += (char)((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    out += (char)v;
+}
+
+void FPPArcadeView::start() {
+    if (started) {
+        return;
+    }
+    started = true;
+    drogon::app().registerController(std::make_shared<FPPArcadeViewController>());
+    timer = drogon::app().getLoop()->runEvery(1.0 / 60.0, [this]() { sendFrames(); });
+}
+
+void FPPArcadeView::stop() {
+    if (started) {
+        drogon::app().getLoop()->invalidateTimer(timer);
+    }
+    std::list<std::shared_ptr<Viewer>> v;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        v.swap(viewers);
+        watched.clear();
+        frames.clear();
+        spares.clear();
+        viewerCount = 0;
+    }
+    for (auto &a : v) {
+        a->conn->shutdown();
+    }
+}
+
+void FPPArcadeView::addViewer(const std::string &model, const drogon::WebSocketConnectionPtr &conn) {
+    std::shared_ptr<Viewer> v = std::make_shared<Viewer>();
+    v->conn = conn;
+    v->model = model;
+    LogDebug(VB_PLUGIN, "FPP Arcade: viewer connected to %s\n", model.c_str());
+    std::lock_guard<std::mutex> l(lock);
+    viewers.push_back(v);
+    watched[model]++;
+    viewerCount++;
+}
+
+void FPPArcadeView::removeViewer(const drogon::WebSocketConnectionPtr &conn) {
+    std::lock_guard<std::mutex> l(lock);
+    for (auto it = viewers.begin(); it != viewers.end(); ++it) {
+        if ((*it)->conn == conn) {
+            if (--watched[(*it)->model] == 0) {
+                watched.erase((*it)->model);
+                frames.erase((*it)->model);
+                spares.erase((*it)->model);
+            }
+            viewers.erase(it);
+            viewerCount--;
+            return;
+        }
+    }
+}
+
+void FPPArcadeView::ack(const drogon::WebSocketConnectionPtr &conn) {
+    std::lock_guard<std::mutex> l(lock);
+    for (auto &v : viewers) {
+        if (v->conn == conn) {
+            v->ackTime = GetTimeMicros();
+            v->awaitingAck = false;
+            return;
+        }
+    }
+}
+
+bool FPPArcadeView::needsFrame(const std::string &model) {
+    std::lock_guard<std::mutex> l(lock);
+    return watched.find(model) != watched.end() && frames.find(model) == frames.end();
+}
+
+void FPPArcadeView::publish(const std::string &model, int width, int height, const uint8_t *indexes, const uint8_t *lut) {
+    std::lock_guard<std::mutex> l(lock);
+    if (watched.find(model) == watched.end()) {
+        return;
+    }
+    // Two frames a model take turns.  The one replaced last time is
+    // refilled unless the send timer is still encoding it, so once both
+    // exist the copy doesn't allocate.
+    std::shared_ptr<Frame> f;
+    f.swap(spares[model]);
+    if (!f || f.use_count() > 1) {
+        f = std::make_shared<Frame>();
+    }
+    f->width = width;
+    f->height = height;
+    f->number = ++frameNumber;
+    f->indexes.assign(indexes, indexes + width * height);
+    f->lut.assign(lut, lut + 256 * 3);
+    std::shared_ptr<Frame> &cur = frames[model];
+    spares[model] = cur;
+    cur = f;
+}
+
+void FPPArcadeView::sendFrames() {
+    std::list<std::pair<std::shared_ptr<Viewer>, std::shared_ptr<const Frame>>> work;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        for (auto &v : viewers) {
+            auto it = frames.find(v->model);
+            if (it != frames.end()) {
+                work.emplace_back(v, it->second);
+            }
+        }
+    }
+    // encoding happens outside the lock so publish() never waits on it
+    uint64_t now = GetTimeMicros();
+    for (auto &w : work) {
+        Viewer &v = *w.first;
+        if (v.awaitingAck) {
+            if (now - v.sentTime < ACK_TIMEOUT_US) {
+                continue;
+            }
+            v.lastKeyframe = 0;
+            v.awaitingAck = false;
+        } else if (v.ackTime > v.sentTime && v.rttSample != v.sentTime) {
+            v.rttSample = v.sentTime;
+            uint64_t r = v.ackTime - v.sentTime;
+            v.rtt = v.rtt ? (v.rtt * 7 + r) / 8 : r;
+        }
+        if (w.second->number == v.lastNumber) {
+            continue;
+        }
+        if (now - v.lastSend < std::max(MIN_SEND_INTERVAL_US, v.rtt)) {
+            continue;
+        }
+        sendFrame(v, *w.second, now);
+    }
+}
+
+void FPPArcadeView::sendFrame(Viewer &v, const Frame &f, uint64_t now) {
+    int count = f.width * f.height;
+    bool key = v.lastKeyframe == 0 || now - v.lastKeyframe > KEYFRAME_INTERVAL_US ||
+               v.width != f.width || v.height != f.height;
+    if (key) {
+        // a keyframe is a delta against black
+        v.last.assign(count * 3, 0);
+        v.width = f.width;
+        v.height = f.height;
+        v.lastKeyframe = now;
+    }
+
+    std::string out;
+    out.reserve(64);
+    out += key ? 'K' : 'D';
+    out += (char)(f.width & 0xFF);
+    out += (char)(f.width >> 8);
+    out += (char)(f.height & 0xFF);
+    out += (char)(f.height >> 8);
+    for (int x = 0; x < 4; x++) {
+        out += (char)((f.number >> (x * 8)) & 0xFF);
+    }
+
+    const uint8_t *lut = f.lut.data();
+    uint8_t *last = v.last.data();
+    uint32_t skip = 0;
+    int i = 0;
+    while (i < count) {
+        const uint8_t *c = lut + f.indexes[i] * 3;
+        uint8_t *l = last + i * 3;
+        if (c[0] == l[0] && c[1] == l[1] && c[2] == l[2]) {
+            skip++;
+            i++;
+            continue;
+        }
+        // run of changed pixels that all become the same color
+        uint32_t run = 0;
+        while (i < count) {
+            const uint8_t *c2 = lut + f.indexes[i] * 3;
+            l = last + i * 3;
+            if (c2[0] != c[0] || c2[1] != c[1] || c2[2] != c[2] ||
+                (l[0] == c[0] && l[1] == c[1] && l[2] == c[2])) {
+                break;
+            }
+            l[0] = c[0];
+            l[1] = c[1];
+            l[2] = c[2];
+            run++;
+            i++;
+        }
+        appendVarint(out, skip);
+        appendVarint(out, run);
+        out.append((const char*)c, 3);
+        skip = 0;
+    }
+
+    v.lastNumber = f.number;
+    v.lastSend = now;
+    v.sentTime = now;
+    v.awaitingAck = true;
+    v.conn->send(out.data(), out.size(), WebSocketMessageType::Binary);
+}
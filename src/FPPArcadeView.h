@@ -0,0 +1,94 @@
+#ifndef __FPPARCADE_VIEW__
+#define __FPPARCADE_VIEW__
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <drogon/WebSocketController.h>
+
+// Spectator streams on the /arcade/view/<model> WebSocket.
+//
+// Canvases hand their palette indexed frame (and the palette as plain RGB,
+// before brightness and color order) to publish(), which copies it into
+// one of two reused buffers under a short lock, so the game thread never
+// waits on a viewer.  A timer on the HTTP loop encodes and sends the
+// newest frame to each viewer that has acknowledged the previous one; a
+// slow client just gets fewer frames.
+//
+// Binary messages, little endian:
+//   uint8  'K' (keyframe, start from black) or 'D' (delta from the last frame)
+//   uint16 width, uint16 height, uint32 frame number
+//   then until the end: varint skip, varint count, uint8 r, g, b
+//   meaning: leave "skip" pixels alone, then set "count" pixels to r,g,b.
+// The client replies with the text message "ack" after drawing each frame.
+class FPPArcadeView {
+public:
+    static FPPArcadeView INSTANCE;
+
+    bool hasViewers() const { return viewerCount > 0; }
+    // true if model has viewers but nothing has been published for them
+    // yet, so a canvas showing a static picture has to send it anyway
+    bool needsFrame(const std::string &model);
+    void publish(const std::string &model, int width, int height, const uint8_t *indexes, const uint8_t *lut);
+
+    // registers the WebSocket controller and starts the send timer
+    void start();
+    void stop();
+
+    void addViewer(const std::string &model, const drogon::WebSocketConnectionPtr &conn);
+    void removeViewer(const drogon::WebSocketConnectionPtr &conn);
+    void ack(const drogon::WebSocketConnectionPtr &conn);
+
+private:
+    class Frame {
+    public:
+        int width;
+        int height;
+        uint64_t number;
+        std::vector<uint8_t> indexes;
+        std::vector<uint8_t> lut;
+    };
+
+    class Viewer {
+    public:
+        drogon::WebSocketConnectionPtr conn;
+        std::string model;
+        std::atomic<bool> awaitingAck{false};
+        std::atomic<uint64_t> sentTime{0};
+        std::atomic<uint64_t> ackTime{0};
+
+        // only used by the send timer
+        uint64_t lastNumber = 0;
+        uint64_t lastKeyframe = 0;
+        uint64_t lastSend = 0;
+        // smoothed time from send to ack, paces the next send
+        uint64_t rtt = 0;
+        uint64_t rttSample = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> last;
+    };
+
+    void sendFrames();
+    void sendFrame(Viewer &v, const Frame &f, uint64_t now);
+
+    std::mutex lock;
+    std::map<std::string, std::shared_ptr<Frame>> frames;
+    // the frame frames[] replaced, refilled by the next publish()
+    std::map<std::string, std::shared_ptr<Frame>> spares;
+    std::map<std::string, int> watched;
+    std::list<std::shared_ptr<Viewer>> viewers;
+    std::atomic<int> viewerCount{0};
+    uint64_t frameNumber = 0;
+
+    bool started = false;
+    uint64_t timer = 0;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include <fpp-pch.h>
 
 #include "FPPBreakout.h"
+#include "FPPArcadeSnapshot.h"
 #include <array>
 #include <random>
 
@@ -9,7 +10,9 @@
 #include "overlays/PixelOverlayEffects.h"
 
 
-FPPBreakout::FPPBreakout(Json::Value &config) : FPPArcadeGame(config) {
+static FPPArcadeGameRegistration<FPPBreakout, FPPArcadeGameOptions> registration("Breakout");
+
+FPPBreakout::FPPBreakout(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options) : FPPArcadeGame(config, options) {
     std::srand(time(NULL));
 }
 FPPBreakout::~FPPBreakout() {
@@ -32,10 +35,11 @@ public:
     float right() const { return x + width - 0.1; }
     float bottom() const { return y + height - 0.1; }
 
-    void draw(PixelOverlayModel *m) {
+    void draw(FPPArcadeCanvas *c) {
+        uint8_t idx = c->color(r, g, b);
         for (int xp = 0; xp < width; xp++) {
             for (int yp = 0; yp < height; yp++) {
-                m->setOverlayPixelValue(xp + x, yp + y, r, g, b);
+                c->setPixel(xp + x, yp + y, idx);
             }
         }
     }
@@ -68,9 +72,9 @@ static std::array<uint32_t, 7> COLORS = {
 
 class BreakoutEffect : public FPPArcadeGameEffect {
 public:
-    BreakoutEffect(PixelOverlayModel *m) : FPPArcadeGameEffect(m) {
-        int w = m->getWidth();
-        int h = m->getHeight();
+    BreakoutEffect(FPPArcadeCanvas *cv) : FPPArcadeGameEffect(cv) {
+        int w = getWidth();
+        int h = getHeight();
         paddle.width = w / 8;
         paddle.x = (w - paddle.width) / 2;
         paddle.height = h / 64;
@@ -114,6 +118,8 @@ public:
         CopyToModel();
     }
     ~BreakoutEffect() {
+        detachFromScheduler();
+        saveSession();
     }
     
     const std::string &name() const override {
@@ -133,9 +139,9 @@ public:
             ball.directionX = std::fabs(ball.directionX);
             ball.x = 0;
         }
-        if (ball.x >= model->getWidth()) {
+        if (ball.x >= getWidth()) {
             ball.directionX = -std::fabs(ball.directionX);
-            ball.x = model->getWidth() - 1;
+            ball.x = getWidth() - 1;
         }
         auto it = blocks.begin();
         while (it != blocks.end()) {
@@ -150,6 +156,8 @@ public:
                     ball.directionY = std::fabs(ball.directionY);
                 }
 
+                int sparks = std::clamp((int)(it->width * it->height), 6, 20);
+                burst(it->x + it->width / 2, it->y + it->height / 2, sparks, it->r, it->g, it->b, it->width * 3);
                 blocks.erase(it);
                 return;
             }
@@ -158,32 +166,37 @@ public:
     }
 
     void CopyToModel() {
-        model->clearOverlayBuffer();
+        clear();
         for (auto &b : blocks) {
-            b.draw(model);
+            b.draw(canvas.get());
         }
-        paddle.draw(model);
-        ball.draw(model);
-        model->flushOverlayBuffer();
+        paddle.draw(canvas.get());
+        ball.draw(canvas.get());
+        present();
     }
     
-    virtual int32_t update() override {
+    virtual int32_t updateGame() override {
         if (!GameOn) {
-            model->clearOverlayBuffer();
-            model->flushOverlayBuffer();
+            clear();
+            present();
             
             if (WaitingUntilOutput) {
-                model->setState(PixelOverlayState(PixelOverlayState::PixelState::Disabled));
+                disable();
                 return 0;
             }
             WaitingUntilOutput = true;
             return -1;
         }
+        if (demo) {
+            // attract mode, keep the paddle under the ball
+            float center = paddle.x + paddle.width / 2;
+            direction = ball.x < center - paddle.height ? -1 : (ball.x > center + paddle.height ? 1 : 0);
+        }
         paddle.x += direction * paddle.height;
         if (paddle.x < 0) {
             paddle.x = 0;
-        } else if ((paddle.x + paddle.width) >= model->getWidth()) {
-            paddle.x = model->getWidth() - paddle.width;
+        } else if ((paddle.x + paddle.width) >= getWidth()) {
+            paddle.x = getWidth() - paddle.width;
         }
         moveBall();
         
@@ -197,21 +210,22 @@ public:
         vec2_norm(ball.directionX, ball.directionY);
 
         CopyToModel();
-        if (ball.y >= model->getHeight()) {
+        if (ball.y >= getHeight()) {
             //end game
             GameOn = false;
+            burst(ball.x, getHeight() - 1, 40, 255, 255, 255, getWidth() / 4, 1000);
             float scl = paddle.height;
-            outputString("GAME", (model->getWidth()-(8 * scl))/ 2 / scl, (model->getHeight()/2-(6 * scl)) / scl, 255, 255, 255, scl);
-            outputString("OVER", (model->getWidth()-(8 * scl))/ 2 / scl, model->getHeight()/2 / scl, 255, 255, 255, scl);
-            model->flushOverlayBuffer();
+            outputString("GAME", (getWidth()-(8 * scl))/ 2 / scl, (getHeight()/2-(6 * scl)) / scl, 255, 255, 255, scl);
+            outputString("OVER", (getWidth()-(8 * scl))/ 2 / scl, getHeight()/2 / scl, 255, 255, 255, scl);
+            present();
             return 2000;
         }
         if (blocks.empty()) {
             GameOn = false;
             float scl = paddle.height;
-            outputString("YOU", (model->getWidth()-(6 * scl))/ 2 / scl, (model->getHeight()/2-(6 * scl)) / scl, 255, 255, 255, scl);
-            outputString("WIN", (model->getWidth()-(6 * scl))/ 2 / scl, model->getHeight()/2 / scl, 255, 255, 255, scl);
-            model->flushOverlayBuffer();
+            outputString("YOU", (getWidth()-(6 * scl))/ 2 / scl, (getHeight()/2-(6 * scl)) / scl, 255, 255, 255, scl);
+            outputString("WIN", (getWidth()-(6 * scl))/ 2 / scl, getHeight()/2 / scl, 255, 255, 255, scl);
+            present();
             return 2000;
         }
         
@@ -238,6 +252,17 @@ public:
         }
     }
     
+    bool serialize(FPPArcadeSnapshot &s) override {
+        if (!GameOn) {
+            return false;
+        }
+        s.io(ball);
+        s.io(paddle);
+        s.io(blocks);
+        s.io(direction);
+        return true;
+    }
+
     Ball ball;
     Block paddle;
     std::list<Block> blocks;
@@ -255,19 +280,19 @@ const std::string &FPPBreakout::getName() {
 }
 
 void FPPBreakout::button(const std::string &button) {
-    PixelOverlayModel *m = PixelOverlayManager::INSTANCE.getModel(modelName);
+    BreakoutEffect *effect = static_cast<BreakoutEffect*>(getEffect());
+    if (effect) {
+        effect->button(button);
+        return;
+    }
+    PixelOverlayModel *m = resolveModel();
     if (m != nullptr) {
-        BreakoutEffect *effect = dynamic_cast<BreakoutEffect*>(m->getRunningEffect());
-        if (!effect) {
-            if (findOption("overlay", "Overwrite") == "Transparent") {
-                m->setState(PixelOverlayState(PixelOverlayState::PixelState::TransparentRGB));
-            } else {
-                m->setState(PixelOverlayState(PixelOverlayState::PixelState::Enabled));
-            }
-            effect = new BreakoutEffect(m);
-            m->setRunningEffect(effect, 50);
-        } else {
-            effect->button(button);
-        }
+        FPPArcadeCanvas *canvas = createCanvas(m);
+        effect = new BreakoutEffect(canvas);
+        startEffect(effect);
     }
 }
+
+FPPArcadeGameEffect *FPPBreakout::createDemo(FPPArcadeCanvas *c) {
+    return new BreakoutEffect(c);
+}
@@ -5,12 +5,15 @@
 
 class FPPBreakout : public FPPArcadeGame {
 public:
-    FPPBreakout(Json::Value &config);
+    FPPBreakout(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options);
     virtual ~FPPBreakout();
     
     virtual const std::string &getName() override;
     
     virtual void button(const std::string &button) override;
+
+protected:
+    virtual FPPArcadeGameEffect *createDemo(FPPArcadeCanvas *c) override;
 };
 
 
@@ -0,0 +1,562 @@
+#include <fpp-pch.h>
+
+#include "FPPInvaders.h"
+#include "FPPArcadeSnapshot.h"
+#include "FPPArcadeSprite.h"
+#include <array>
+#include <mutex>
+#include <random>
+
+#include "overlays/PixelOverlay.h"
+#include "overlays/PixelOverlayModel.h"
+#include "overlays/PixelOverlayEffects.h"
+
+
+FPPInvadersOptions::FPPInvadersOptions(const Json::Value &config) : FPPArcadeGameOptions(config) {
+    pixelScaling = intOption(config, "Pixel Scaling", 1, 1, 20);
+}
+
+static FPPArcadeGameRegistration<FPPInvaders, FPPInvadersOptions> registration("Invaders");
+
+FPPInvaders::FPPInvaders(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options) : FPPArcadeGame(config, options) {
+    std::srand(time(NULL));
+}
+FPPInvaders::~FPPInvaders() {
+}
+
+static const std::vector<std::vector<std::string>> INVADER_ART = {
+    {"...##...", "..####..", ".##..##.", "..####..", ".#....#."},
+    {"...##...", "..####..", ".##..##.", "..####..", "#......#"},
+    {".#....#.", "..####..", ".######.", "##.##.##", "#......#"},
+    {".#....#.", "#.####.#", "########", ".#.##.#.", ".#....#."},
+    {"..####..", ".######.", "##.##.##", "########", ".#.##.#."},
+    {"..####..", ".######.", "##.##.##", "########", "#..##..#"},
+};
+static const std::vector<std::string> PLAYER_ART = {"...#...", "..###..", "#######", "#######"};
+static const std::vector<std::string> SHIELD_ART = {"..######..", ".########.", "##########", "###....###", "##......##"};
+static const std::vector<std::string> UFO_ART = {"..######..", ".#.#..#.#.", "##########"};
+static const std::vector<std::string> EXPLOSION_ART = {"#..#..#.", ".#.#.#..", "..#.#.##", ".#.#.#..", "#..#..#."};
+static const std::vector<std::string> SHOT_ART = {"#", "#", "#"};
+static const std::vector<std::string> BOMB_ART[2] = {{"#.", ".#", "#."}, {".#", "#.", ".#"}};
+
+// Board in logical pixels (after scaling):
+//   row 0-4    score and lives
+//   row 6-8    the saucer
+//   row 10-    the formation, 11 x 5 on a 128x64 model
+//   rows-14    shields
+//   rows-5     the player
+class InvadersEffect : public FPPArcadeGameEffect {
+public:
+    static constexpr int PITCH_X = 10;
+    static constexpr int PITCH_Y = 7;
+    static constexpr int TICK_MS = 20;
+
+    class Shot {
+    public:
+        FPPArcadeSprite sprite;
+        int dy = 0;
+
+        void serialize(FPPArcadeSnapshot &s) {
+            s.io(sprite);
+            s.io(dy);
+        }
+    };
+    class Explosion {
+    public:
+        FPPArcadeSprite sprite;
+        int ticks = 0;
+
+        void serialize(FPPArcadeSnapshot &s) {
+            s.io(sprite);
+            s.io(ticks);
+        }
+    };
+
+    InvadersEffect(int sc, FPPArcadeCanvas *cv) : FPPArcadeGameEffect(cv),
+        shots(makeShot()),
+        bombs(makeBomb()),
+        explosions(makeExplosion()) {
+        getSize(cols, rows);
+        scale = sc;
+        cols /= sc;
+        rows /= sc;
+        offsetX = 0;
+        offsetY = 0;
+
+        gridCols = std::clamp((cols - 8) / PITCH_X, 1, 11);
+        gridRows = std::clamp((rows - 30) / PITCH_Y, 1, 5);
+
+        static const int ROW_COLORS[3][3] = {{255, 0, 255}, {0, 255, 255}, {0, 255, 0}};
+        for (int t = 0; t < 3; t++) {
+            uint8_t c = color(ROW_COLORS[t][0], ROW_COLORS[t][1], ROW_COLORS[t][2]);
+            invaderFrames[t][0] = std::make_shared<FPPArcadeSpriteFrame>(INVADER_ART[t * 2], c);
+            invaderFrames[t][1] = std::make_shared<FPPArcadeSpriteFrame>(INVADER_ART[t * 2 + 1], c);
+        }
+        player = FPPArcadeSprite(std::make_shared<FPPArcadeSpriteFrame>(PLAYER_ART, color(0, 255, 0)));
+        ufo = FPPArcadeSprite(std::make_shared<FPPArcadeSpriteFrame>(UFO_ART, color(255, 0, 0)));
+        ufo.active = false;
+        player.x = cols / 2 - player.getWidth() / 2;
+        player.y = rows - 5;
+        startWave();
+    }
+    ~InvadersEffect() {
+        detachFromScheduler();
+        saveSession();
+    }
+
+    const std::string &name() const override {
+        static std::string NAME = "Invaders";
+        return NAME;
+    }
+
+    // prototypes for the pools, built before the constructor body runs
+    Shot makeShot() {
+        Shot s;
+        s.sprite = FPPArcadeSprite(std::make_shared<FPPArcadeSpriteFrame>(SHOT_ART, canvas->color(255, 255, 255)));
+        s.dy = -2;
+        return s;
+    }
+    Shot makeBomb() {
+        Shot s;
+        uint8_t c = canvas->color(255, 255, 0);
+        s.sprite = FPPArcadeSprite(std::make_shared<FPPArcadeSpriteFrame>(BOMB_ART[0], c));
+        s.sprite.addFrame(std::make_shared<FPPArcadeSpriteFrame>(BOMB_ART[1], c));
+        s.dy = 1;
+        return s;
+    }
+    Explosion makeExplosion() {
+        Explosion e;
+        e.sprite = FPPArcadeSprite(std::make_shared<FPPArcadeSpriteFrame>(EXPLOSION_ART, canvas->color(255, 128, 0)));
+        return e;
+    }
+
+    void startWave() {
+        invaders.clear();
+        points.clear();
+        formationX = (cols - gridCols * PITCH_X) / 2;
+        formationY = 10 + std::min(wave, 4) * 2;
+        marchDir = 1;
+        for (int r = 0; r < gridRows; r++) {
+            // squids on top, crabs in the middle, octopuses at the bottom
+            int t = r == 0 ? 0 : (r * 3 / gridRows);
+            t = std::min(t, 2);
+            for (int c = 0; c < gridCols; c++) {
+                FPPArcadeSprite s(invaderFrames[t][0]);
+                s.addFrame(invaderFrames[t][1]);
+                invaders.push_back(s);
+                points.push_back(30 - t * 10);
+            }
+        }
+        alive = invaders.size();
+        placeInvaders();
+
+        shields.clear();
+        auto shieldFrame = std::make_shared<FPPArcadeSpriteFrame>(SHIELD_ART, color(0, 160, 0));
+        int count = std::clamp(cols / 32, 1, 4);
+        for (int x = 0; x < count; x++) {
+            FPPArcadeSprite s(shieldFrame, (cols * (2 * x + 1)) / (2 * count) - shieldFrame->getWidth() / 2, rows - 14);
+            // each one gets its own copy as soon as it's hit
+            shields.push_back(s);
+        }
+        shots.clear();
+        bombs.clear();
+    }
+
+    void placeInvaders() {
+        for (int r = 0; r < gridRows; r++) {
+            for (int c = 0; c < gridCols; c++) {
+                FPPArcadeSprite &s = invaders[r * gridCols + c];
+                s.x = formationX + c * PITCH_X;
+                s.y = formationY + r * PITCH_Y;
+                s.setFrame(marchFrame);
+            }
+        }
+    }
+
+    void march() {
+        // the fewer left, the faster they go
+        if (++marchCount < 1 + alive * 25 / (int)invaders.size()) {
+            return;
+        }
+        marchCount = 0;
+        int minX = cols;
+        int maxX = 0;
+        for (auto &s : invaders) {
+            if (s.active) {
+                minX = std::min(minX, s.x);
+                maxX = std::max(maxX, s.x + s.getWidth());
+            }
+        }
+        if ((marchDir > 0 && maxX + 2 > cols) || (marchDir < 0 && minX - 2 < 0)) {
+            marchDir = -marchDir;
+            formationY += 2;
+        } else {
+            formationX += marchDir * 2;
+        }
+        marchFrame ^= 1;
+        placeInvaders();
+    }
+
+    // the lowest invader still alive in each column drops the bombs
+    void dropBombs() {
+        int chance = std::max(4, 40 - wave * 6);
+        if (rand() % chance != 0) {
+            return;
+        }
+        int c = rand() % gridCols;
+        for (int r = gridRows - 1; r >= 0; r--) {
+            FPPArcadeSprite &s = invaders[r * gridCols + c];
+            if (s.active) {
+                Shot *b = bombs.acquire();
+                if (b) {
+                    b->sprite.x = s.x + s.getWidth() / 2;
+                    b->sprite.y = s.y + s.getHeight();
+                }
+                return;
+            }
+        }
+    }
+
+    void explode(const FPPArcadeSprite &s) {
+        Explosion *e = explosions.acquire();
+        if (e) {
+            e->sprite.x = s.x;
+            e->sprite.y = s.y;
+            e->ticks = 8;
+        }
+    }
+
+    // only the invaders in the grid cells the shot could be touching are
+    // tested, not the whole formation
+    bool hitInvader(FPPArcadeSprite &shot) {
+        int c = (shot.x - formationX) / PITCH_X;
+        int r0 = (shot.y - formationY) / PITCH_Y;
+        if (shot.x < formationX || c >= gridCols) {
+            return false;
+        }
+        for (int r = std::max(0, r0 - 1); r <= std::min(gridRows - 1, r0 + 1); r++) {
+            FPPArcadeSprite &s = invaders[r * gridCols + c];
+            if (s.collides(shot)) {
+                s.active = false;
+                alive--;
+                score += points[r * gridCols + c];
+                explode(s);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool hitShield(FPPArcadeSprite &shot) {
+        for (auto &s : shields) {
+            if (s.collides(shot)) {
+                s.makeUnique().erase(shot.x - s.x, shot.y + (shot.getHeight() / 2) - s.y, 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void moveShots() {
+        shots.forEach([this](Shot &s) {
+            s.sprite.y += s.dy;
+            if (s.sprite.y + s.sprite.getHeight() < 0) {
+                shots.release(&s);
+            } else if (hitInvader(s.sprite) || hitShield(s.sprite)) {
+                shots.release(&s);
+            } else if (ufo.collides(s.sprite)) {
+                ufo.active = false;
+                score += 100;
+                explode(ufo);
+                shots.release(&s);
+            }
+        });
+        bombFrame ^= 1;
+        bombs.forEach([this](Shot &b) {
+            b.sprite.y += b.dy;
+            b.sprite.setFrame(bombFrame);
+            if (b.sprite.y >= rows) {
+                bombs.release(&b);
+            } else if (hitShield(b.sprite)) {
+                bombs.release(&b);
+            } else if (respawn == 0 && player.collides(b.sprite)) {
+                bombs.release(&b);
+                playerHit();
+            } else {
+                // shots and bombs cancel each other out
+                bool hit = false;
+                shots.forEach([&](Shot &s) {
+                    if (!hit && s.sprite.collides(b.sprite)) {
+                        shots.release(&s);
+                        bombs.release(&b);
+                        hit = true;
+                    }
+                });
+            }
+        });
+    }
+
+    void playerHit() {
+        explode(player);
+        lives--;
+        respawn = 50;
+        bombs.clear();
+        if (lives <= 0) {
+            GameOn = false;
+        }
+    }
+
+    void moveUFO() {
+        if (ufo.active) {
+            if (++ufoStep % 2 == 0) {
+                ufo.x += ufoDir;
+            }
+            if (ufo.x > cols || ufo.x + ufo.getWidth() < 0) {
+                ufo.active = false;
+            }
+        } else if (rand() % 1200 == 0) {
+            ufoDir = (rand() % 2) ? 1 : -1;
+            ufo.x = ufoDir > 0 ? -ufo.getWidth() : cols;
+            ufo.y = 6;
+            ufo.active = true;
+        }
+    }
+
+    void checkInvasion() {
+        for (auto &s : invaders) {
+            if (!s.active) {
+                continue;
+            }
+            for (auto &sh : shields) {
+                sh.erode(s);
+            }
+            if (s.y + s.getHeight() >= player.y) {
+                GameOn = false;
+            }
+        }
+    }
+
+    // attract mode: chase the lowest invader in a column and keep firing
+    void autopilot() {
+        int target = -1;
+        for (int c = 0; c < gridCols && target < 0; c++) {
+            int col = (c + demoColumn) % gridCols;
+            for (int r = 0; r < gridRows; r++) {
+                if (invaders[r * gridCols + col].active) {
+                    target = invaders[r * gridCols + col].x + 4;
+                    break;
+                }
+            }
+        }
+        int center = player.x + player.getWidth() / 2;
+        if (target < 0 || target == center) {
+            direction = 0;
+            demoColumn = rand() % gridCols;
+            button("Fire - Pressed");
+        } else {
+            direction = target < center ? -1 : 1;
+        }
+    }
+
+    void draw() {
+        clear();
+        for (auto &s : shields) {
+            s.draw(this);
+        }
+        for (auto &s : invaders) {
+            s.draw(this);
+        }
+        ufo.draw(this);
+        if (respawn == 0) {
+            player.draw(this);
+        }
+        shots.forEach([this](Shot &s) { s.sprite.draw(this); });
+        bombs.forEach([this](Shot &b) { b.sprite.draw(this); });
+        explosions.forEach([this](Explosion &e) {
+            e.sprite.draw(this);
+            if (--e.ticks <= 0) {
+                explosions.release(&e);
+            }
+        });
+        outputString(std::to_string(score), 0, 0);
+        for (int x = 0; x < lives - 1; x++) {
+            outputPixel(cols - 2 - x * 3, 1, 0, 255, 0);
+            outputPixel(cols - 2 - x * 3, 2, 0, 255, 0);
+        }
+    }
+
+    virtual int32_t updateGame() override {
+        if (enteringInitials()) {
+            return updateInitials();
+        }
+        if (!GameOn) {
+            if (WaitingUntilOutput) {
+                disable();
+                return 0;
+            }
+            clear();
+            present();
+            WaitingUntilOutput = true;
+            return -1;
+        }
+        if (demo) {
+            autopilot();
+        }
+        if (respawn > 0) {
+            respawn--;
+        } else {
+            player.x = std::clamp(player.x + direction, 0, cols - player.getWidth());
+        }
+        {
+            // fire presses come from the input thread, the shots pool is
+            // only touched here
+            std::lock_guard<std::mutex> l(fireLock);
+            if (fireRequested) {
+                fireRequested = false;
+                fire();
+            }
+        }
+        march();
+        dropBombs();
+        moveShots();
+        moveUFO();
+        checkInvasion();
+        if (alive == 0) {
+            wave++;
+            startWave();
+        }
+        draw();
+        if (!GameOn) {
+            outputString("GAME", cols / 2 - 8, rows / 2 - 9);
+            outputString("OVER", cols / 2 - 8, rows / 2 - 3);
+            std::string s = std::to_string(score);
+            outputString(s, cols / 2 - s.size() * 2, rows / 2 + 3);
+            gameOver(score);
+            present();
+            return 2000;
+        }
+        present();
+        return TICK_MS;
+    }
+
+    void button(const std::string &button) {
+        if (initialsButton(button)) {
+            return;
+        }
+        if (button == "Left - Pressed") {
+            direction = -1;
+        } else if (button == "Left - Released") {
+            direction = 0;
+        } else if (button == "Right - Pressed") {
+            direction = 1;
+        } else if (button == "Right - Released") {
+            direction = 0;
+        } else if (button == "Fire - Pressed" || button == "Up - Pressed") {
+            std::lock_guard<std::mutex> l(fireLock);
+            fireRequested = true;
+        }
+    }
+    void fire() {
+        if (respawn == 0 && shots.size() < 2) {
+            Shot *s = shots.acquire();
+            if (s) {
+                s->sprite.x = player.x + player.getWidth() / 2;
+                s->sprite.y = player.y - s->sprite.getHeight();
+            }
+        }
+    }
+
+    bool serialize(FPPArcadeSnapshot &s) override {
+        if (!GameOn) {
+            return false;
+        }
+        // the constructor built every sprite, only their state is saved
+        s.ioEach(invaders);
+        s.ioEach(shields);
+        for (auto &sh : shields) {
+            sh.makeUnique().serialize(s);
+        }
+        s.io(player);
+        s.io(ufo);
+        s.io(points);
+        s.io(alive);
+        s.io(formationX);
+        s.io(formationY);
+        s.io(marchDir);
+        s.io(marchCount);
+        s.io(marchFrame);
+        s.io(ufoDir);
+        s.io(ufoStep);
+        s.io(shots);
+        s.io(bombs);
+        s.io(explosions);
+        s.io(bombFrame);
+        s.io(direction);
+        s.io(score);
+        s.io(lives);
+        s.io(wave);
+        s.io(respawn);
+        return true;
+    }
+
+    int rows = 64;
+    int cols = 128;
+    int gridCols = 11;
+    int gridRows = 5;
+
+    std::array<std::array<std::shared_ptr<FPPArcadeSpriteFrame>, 2>, 3> invaderFrames;
+    std::vector<FPPArcadeSprite> invaders;
+    std::vector<int> points;
+    int alive = 0;
+    int formationX = 0;
+    int formationY = 10;
+    int marchDir = 1;
+    int marchCount = 0;
+    int marchFrame = 0;
+
+    std::vector<FPPArcadeSprite> shields;
+    FPPArcadeSprite player;
+    FPPArcadeSprite ufo;
+    int ufoDir = 1;
+    int ufoStep = 0;
+
+    FPPArcadePool<Shot, 4> shots;
+    std::mutex fireLock;
+    bool fireRequested = false;
+    FPPArcadePool<Shot, 32> bombs;
+    FPPArcadePool<Explosion, 16> explosions;
+    int bombFrame = 0;
+
+    int direction = 0;
+    int demoColumn = 0;
+    int score = 0;
+    int lives = 3;
+    int wave = 0;
+    int respawn = 0;
+
+    bool GameOn = true;
+    bool WaitingUntilOutput = false;
+};
+
+const std::string &FPPInvaders::getName() {
+    static const std::string name = "Invaders";
+    return name;
+}
+
+void FPPInvaders::button(const std::string &button) {
+    InvadersEffect *effect = static_cast<InvadersEffect*>(getEffect());
+    if (effect) {
+        effect->button(button);
+        return;
+    }
+    PixelOverlayModel *m = resolveModel();
+    if (m != nullptr) {
+        FPPArcadeCanvas *canvas = createCanvas(m);
+        effect = new InvadersEffect(getOptions().pixelScaling, canvas);
+        startEffect(effect);
+    }
+}
+
+FPPArcadeGameEffect *FPPInvaders::createDemo(FPPArcadeCanvas *c) {
+    return new InvadersEffect(getOptions().pixelScaling, c);
+}
@@ -0,0 +1,29 @@
+#ifndef __FPPARCADE_INVADERS_
+#define __FPPARCADE_INVADERS_
+
+#include "FPPArcade.h"
+
+class FPPInvadersOptions : public FPPArcadeGameOptions {
+public:
+    FPPInvadersOptions(const Json::Value &config);
+
+    int pixelScaling;
+};
+
+class FPPInvaders : public FPPArcadeGame {
+public:
+    FPPInvaders(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options);
+    virtual ~FPPInvaders();
+
+    virtual const std::string &getName() override;
+
+    virtual void button(const std::string &button) override;
+
+    const FPPInvadersOptions &getOptions() const { return static_cast<const FPPInvadersOptions&>(*options); }
+
+protected:
+    virtual FPPArcadeGameEffect *createDemo(FPPArcadeCanvas *c) override;
+};
+
+
+#endif
@@ -0,0 +1,386 @@
+#include <fpp-pch.h>
+
+#include "FPPLife.h"
+#include "FPPArcadeSnapshot.h"
+#include <array>
+#include <mutex>
+#include <random>
+
+#include "FPPArcadeScheduler.h"
+#include "FPPArcadeTrace.h"
+
+#include "overlays/PixelOverlay.h"
+#include "overlays/PixelOverlayModel.h"
+#include "overlays/PixelOverlayEffects.h"
+
+
+// "B3/S23" style rule strings
+static bool parseRule(const std::string &rule, uint16_t &birth, uint16_t &survive) {
+    birth = 0;
+    survive = 0;
+    uint16_t *cur = nullptr;
+    for (auto ch : rule) {
+        if (ch == 'B' || ch == 'b') {
+            cur = &birth;
+        } else if (ch == 'S' || ch == 's') {
+            cur = &survive;
+        } else if (ch >= '0' && ch <= '8' && cur) {
+            *cur |= 1 << (ch - '0');
+        } else if (ch != '/' && ch != ' ') {
+            return false;
+        }
+    }
+    return birth != 0;
+}
+
+FPPLifeOptions::FPPLifeOptions(const Json::Value &config) : FPPArcadeGameOptions(config) {
+    pixelScaling = intOption(config, "Pixel Scaling", 1, 1, 20);
+    speed = intOption(config, "Speed", 50, 10, 1000);
+    wrap = choiceOption(config, "Edges", {"Wrap", "Dead"}) == "Wrap";
+    std::string rule = findOption(config, "Rule", "B3/S23");
+    if (!parseRule(rule, birth, survive)) {
+        LogErr(VB_PLUGIN, "FPP Arcade %s on model %s: rule \"%s\" is not valid, using B3/S23\n",
+               game.c_str(), model.c_str(), rule.c_str());
+        parseRule("B3/S23", birth, survive);
+    }
+}
+
+static FPPArcadeGameRegistration<FPPLife, FPPLifeOptions> registration("Life");
+
+FPPLife::FPPLife(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options) : FPPArcadeGame(config, options) {
+}
+FPPLife::~FPPLife() {
+}
+
+// patterns the player can drop, 'O' is a live cell
+static const std::vector<std::vector<std::string>> PATTERNS = {
+    {".O.", "..O", "OOO"},                                   // glider
+    {".O..O", "O....", "O...O", "OOOO."},                    // lightweight spaceship
+    {".OO", "OO.", ".O."},                                   // R-pentomino
+    {".O.....", "...O...", "OO..OOO"},                       // acorn
+    {"OOO.O", "O....", "...OO", ".OO.O", "O.O.O"},           // infinite growth
+};
+
+class LifeEffect : public FPPArcadeGameEffect {
+public:
+    LifeEffect(const FPPLifeOptions &o, FPPArcadeCanvas *cv) : FPPArcadeGameEffect(cv),
+        wrap(o.wrap), birth(o.birth), survive(o.survive), speed(o.speed), rng(std::random_device()()) {
+        getSize(cols, rows);
+        // at least one cell each way, whatever the model
+        scale = std::clamp(o.pixelScaling, 1, std::max(1, std::min(cols, rows)));
+        if (scale != o.pixelScaling) {
+            LogWarn(VB_PLUGIN, "FPP Arcade Life: Pixel Scaling %d is larger than the %dx%d model, using %d\n",
+                    o.pixelScaling, cols, rows, scale);
+        }
+        cols /= scale;
+        rows /= scale;
+        offsetX = 0;
+        offsetY = 0;
+        words = (cols + 63) / 64;
+        lastMask = (cols % 64) ? ((1ULL << (cols % 64)) - 1) : ~0ULL;
+        grid.resize(rows * words);
+        next.resize(rows * words);
+        cursorX = cols / 2;
+        cursorY = rows / 2;
+        liveColor = color(0, 255, 0);
+        cursorColor = color(255, 255, 255);
+        seed();
+    }
+    ~LifeEffect() {
+        detachFromScheduler();
+        saveSession();
+    }
+    const std::string &name() const override {
+        static std::string NAME = "Life";
+        return NAME;
+    }
+
+    uint64_t *row(std::vector<uint64_t> &g, int r) {
+        return &g[r * words];
+    }
+    bool get(int x, int y) {
+        return (grid[y * words + x / 64] >> (x % 64)) & 1;
+    }
+    void set(int x, int y) {
+        if (wrap) {
+            x = (x + cols) % cols;
+            y = (y + rows) % rows;
+        } else if (x < 0 || y < 0 || x >= cols || y >= rows) {
+            return;
+        }
+        grid[y * words + x / 64] |= 1ULL << (x % 64);
+    }
+
+    void seed() {
+        std::uniform_int_distribution<uint64_t> dist;
+        for (int r = 0; r < rows; r++) {
+            uint64_t *g = row(grid, r);
+            for (int w = 0; w < words; w++) {
+                // about 25% alive
+                g[w] = dist(rng) & dist(rng);
+            }
+            g[words - 1] &= lastMask;
+        }
+        stableCount = 0;
+    }
+
+    // neighbor from the word to the left/right, pulled in at the edge bits
+    uint64_t leftIn(const uint64_t *r, int w) const {
+        if (w > 0) {
+            return r[w - 1] >> 63;
+        }
+        return wrap ? (r[(cols - 1) / 64] >> ((cols - 1) % 64)) & 1 : 0;
+    }
+    uint64_t rightIn(const uint64_t *r, int w) const {
+        if (w < words - 1) {
+            return r[w + 1] << 63;
+        }
+        return wrap ? (r[0] & 1) << ((cols - 1) % 64) : 0;
+    }
+
+    // Steps rows [start, end) 64 cells at a time.  The eight neighbor words
+    // are added into four bit planes (a bit sliced counter), then the rule
+    // is applied to all 64 cells with a few ANDs/ORs per neighbor count.
+    void stepRows(int start, int end) {
+        for (int y = start; y < end; y++) {
+            const uint64_t *up;
+            const uint64_t *down;
+            if (y > 0) {
+                up = &grid[(y - 1) * words];
+            } else {
+                up = wrap ? &grid[(rows - 1) * words] : nullptr;
+            }
+            if (y < rows - 1) {
+                down = &grid[(y + 1) * words];
+            } else {
+                down = wrap ? &grid[0] : nullptr;
+            }
+            const uint64_t *cur = &grid[y * words];
+            uint64_t *out = &next[y * words];
+            for (int w = 0; w < words; w++) {
+                uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+                auto add = [&](uint64_t n) {
+                    uint64_t c0 = s0 & n;
+                    s0 ^= n;
+                    uint64_t c1 = s1 & c0;
+                    s1 ^= c0;
+                    uint64_t c2 = s2 & c1;
+                    s2 ^= c1;
+                    s3 |= c2;
+                };
+                auto addRow = [&](const uint64_t *r, bool center) {
+                    uint64_t v = r[w];
+                    add((v << 1) | leftIn(r, w));
+                    add((v >> 1) | rightIn(r, w));
+                    if (center) {
+                        add(v);
+                    }
+                };
+                if (up) {
+                    addRow(up, true);
+                }
+                if (down) {
+                    addRow(down, true);
+                }
+                addRow(cur, false);
+
+                uint64_t alive = cur[w];
+                uint64_t result = 0;
+                for (int n = 0; n <= 8; n++) {
+                    uint16_t bit = 1 << n;
+                    if (!((birth | survive) & bit)) {
+                        continue;
+                    }
+                    uint64_t eq = ((n & 1) ? s0 : ~s0) & ((n & 2) ? s1 : ~s1) &
+                                  ((n & 4) ? s2 : ~s2) & ((n & 8) ? s3 : ~s3);
+                    if (birth & bit) {
+                        result |= eq & ~alive;
+                    }
+                    if (survive & bit) {
+                        result |= eq & alive;
+                    }
+                }
+                out[w] = result;
+            }
+            out[words - 1] &= lastMask;
+        }
+    }
+
+    void step() {
+        ARCADE_TRACE("life step");
+        // big boards are split into bands of rows across the worker pool
+        int bands = std::min(rows / 32, FPPArcadeScheduler::INSTANCE.getWorkers().getThreadCount() + 1);
+        if (bands <= 1) {
+            stepRows(0, rows);
+        } else {
+            int per = (rows + bands - 1) / bands;
+            FPPArcadeScheduler::INSTANCE.getWorkers().parallelFor(bands, [this, per](int b) {
+                stepRows(b * per, std::min(rows, (b + 1) * per));
+            });
+        }
+        grid.swap(next);
+
+        // Still lifes and short period oscillators repeat the population
+        // count, once it's been that way for a while the board is done.
+        int pop = 0;
+        for (auto w : grid) {
+            pop += __builtin_popcountll(w);
+        }
+        bool repeat = false;
+        for (auto p : populations) {
+            repeat |= p == pop;
+        }
+        stableCount = repeat ? stableCount + 1 : 0;
+        populations[generation++ % populations.size()] = pop;
+    }
+
+    void dropPattern(int px, int py, int pat) {
+        const std::vector<std::string> &p = PATTERNS[pat];
+        for (int y = 0; y < p.size(); y++) {
+            for (int x = 0; x < p[y].size(); x++) {
+                if (p[y][x] == 'O') {
+                    set(px + x, py + y);
+                }
+            }
+        }
+        stableCount = 0;
+    }
+
+    void CopyToModel() {
+        clear();
+        for (int y = 0; y < rows; y++) {
+            const uint64_t *r = &grid[y * words];
+            for (int w = 0; w < words; w++) {
+                uint64_t v = r[w];
+                while (v) {
+                    int b = __builtin_ctzll(v);
+                    v &= v - 1;
+                    outputPixel(w * 64 + b, y, liveColor);
+                }
+            }
+        }
+        int cx, cy, pat;
+        {
+            std::lock_guard<std::mutex> l(inputLock);
+            cx = cursorX;
+            cy = cursorY;
+            pat = pattern;
+        }
+        if (cursorShown) {
+            const std::vector<std::string> &p = PATTERNS[pat];
+            for (int y = 0; y < p.size(); y++) {
+                for (int x = 0; x < p[y].size(); x++) {
+                    if (p[y][x] == 'O') {
+                        outputPixel(cx + x, cy + y, cursorColor);
+                    }
+                }
+            }
+        }
+        present();
+    }
+
+    virtual int32_t updateGame() override {
+        {
+            // drops come from the input thread, apply them between steps
+            std::lock_guard<std::mutex> l(inputLock);
+            for (auto &d : drops) {
+                dropPattern(d[0], d[1], d[2]);
+            }
+            drops.clear();
+            // the cursor only shows for a while after the player moves it
+            cursorShown = GetTimeMS() < cursorUntil;
+        }
+        step();
+        if (stableCount > 100) {
+            // died out or froze, start a new soup
+            seed();
+        }
+        CopyToModel();
+        return speed;
+    }
+
+    void button(const std::string &button) {
+        std::lock_guard<std::mutex> l(inputLock);
+        if (button == "Left - Pressed") {
+            cursorX = (cursorX + cols - 1) % cols;
+        } else if (button == "Right - Pressed") {
+            cursorX = (cursorX + 1) % cols;
+        } else if (button == "Up - Pressed") {
+            cursorY = (cursorY + rows - 1) % rows;
+        } else if (button == "Down - Pressed") {
+            cursorY = (cursorY + 1) % rows;
+        } else if (button == "Fire - Pressed") {
+            drops.push_back({cursorX, cursorY, pattern});
+            pattern = (pattern + 1) % PATTERNS.size();
+        } else {
+            return;
+        }
+        cursorUntil = GetTimeMS() + 3000;
+    }
+
+    bool serialize(FPPArcadeSnapshot &s) override {
+        s.io(grid);
+        s.io(stableCount);
+        s.io(populations);
+        s.io(generation);
+        std::lock_guard<std::mutex> l(inputLock);
+        s.io(cursorX);
+        s.io(cursorY);
+        s.io(pattern);
+        s.io(rng);
+        s.io(drops);
+        return grid.size() == rows * words;
+    }
+
+    int rows = 0;
+    int cols = 0;
+    int words = 0;
+    uint64_t lastMask = 0;
+    std::vector<uint64_t> grid;
+    std::vector<uint64_t> next;
+
+    bool wrap;
+    uint16_t birth;
+    uint16_t survive;
+    int speed;
+    int stableCount = 0;
+    std::array<int, 3> populations = {-1, -1, -1};
+    uint64_t generation = 0;
+
+    // the drops and the cursor are changed by the input thread
+    std::mutex inputLock;
+    std::vector<std::array<int, 3>> drops;
+    int cursorX = 0;
+    int cursorY = 0;
+    int pattern = 0;
+    long long cursorUntil = 0;
+
+    bool cursorShown = false;
+    uint8_t liveColor;
+    uint8_t cursorColor;
+
+    std::mt19937_64 rng;
+};
+
+const std::string &FPPLife::getName() {
+    static const std::string name = "Life";
+    return name;
+}
+
+void FPPLife::button(const std::string &button) {
+    LifeEffect *effect = static_cast<LifeEffect*>(getEffect());
+    if (effect) {
+        effect->button(button);
+        return;
+    }
+    PixelOverlayModel *m = resolveModel();
+    if (m != nullptr) {
+        FPPArcadeCanvas *canvas = createCanvas(m);
+        effect = new LifeEffect(getOptions(), canvas);
+        startEffect(effect);
+    }
+}
+
+FPPArcadeGameEffect *FPPLife::createDemo(FPPArcadeCanvas *c) {
+    return new LifeEffect(getOptions(), c);
+}
@@ -0,0 +1,35 @@
+#ifndef __FPPARCADE_LIFE_
+#define __FPPARCADE_LIFE_
+
+#include "FPPArcade.h"
+
+class FPPLifeOptions : public FPPArcadeGameOptions {
+public:
+    FPPLifeOptions(const Json::Value &config);
+
+    int pixelScaling;
+    // ms per generation
+    int speed;
+    bool wrap;
+    // bit n set: a dead cell with n neighbors is born / a live one survives
+    uint16_t birth;
+    uint16_t survive;
+};
+
+class FPPLife : public FPPArcadeGame {
+public:
+    FPPLife(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options);
+    virtual ~FPPLife();
+
+    virtual const std::string &getName() override;
+
+    virtual void button(const std::string &button) override;
+
+    const FPPLifeOptions &getOptions() const { return static_cast<const FPPLifeOptions&>(*options); }
+
+protected:
+    virtual FPPArcadeGameEffect *createDemo(FPPArcadeCanvas *c) override;
+};
+
+
+#endif
@@ -1,23 +1,50 @@
 #include <fpp-pch.h>
 
 #include "FPPPong.h"
+#include "FPPArcadeSnapshot.h"
+#include "FPPArcadeText.h"
 #include <array>
+#include <climits>
 #include <cmath>
+#include <mutex>
+#include <random>
 
 #include "overlays/PixelOverlay.h"
 #include "overlays/PixelOverlayModel.h"
 #include "overlays/PixelOverlayEffects.h"
 
 
-FPPPong::FPPPong(Json::Value &config) : FPPArcadeGame(config) {
+FPPPongOptions::FPPPongOptions(const Json::Value &config) : FPPArcadeGameOptions(config) {
+    pixelScaling = intOption(config, "Pixel Scaling", 1, 1, 20);
+    controls = intOption(config, "Controls", 1, 1, 3);
+    opponent = choiceOption(config, "Opponent", {"Human", "Computer", "Attract"});
+    aiReaction = intOption(config, "AI Reaction", 150, 0, 2000);
+    aiError = intOption(config, "AI Error", 2, 0, 50);
+    netplayOptions(config, netplay);
+}
+
+static FPPArcadeGameRegistration<FPPPong, FPPPongOptions> registration("Pong");
+
+FPPPong::FPPPong(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options) : FPPArcadeGame(config, options) {
 }
 FPPPong::~FPPPong() {
 }
 
-class PongEffect : public FPPArcadeGameEffect {
+class PongEffect : public FPPArcadeGameEffect, public FPPArcadeNetGame {
 public:
-    PongEffect(int sc, int c, PixelOverlayModel *m) : FPPArcadeGameEffect(m), controls(c) {
-        m->getSize(cols, rows);
+    // Drives one paddle.  It only re-aims when the ball changes horizontal
+    // direction (a serve or a paddle hit) and then only after the reaction
+    // delay, and its aim is off by up to the error, so it can be beaten.
+    class AI {
+    public:
+        bool enabled = false;
+        float lastDirX = 0;
+        int replanIn = -1;
+        float target = 0;
+    };
+
+    PongEffect(int sc, const FPPPongOptions &o, FPPArcadeCanvas *cv) : FPPArcadeGameEffect(cv), controls(o.controls) {
+        getSize(cols, rows);
         scale = sc;
         cols /= sc;
         rows /= sc;
@@ -32,26 +59,68 @@ public:
         
         ballPosX = cols / 2;
         ballPosY = rows / 2;
+
+        ai[0].enabled = o.opponent == "Attract";
+        ai[1].enabled = o.opponent != "Human";
+        aiDelay = o.aiReaction / timer;
+        aiError = o.aiError;
+        for (auto &a : ai) {
+            a.target = rows / 2;
+        }
     }
     ~PongEffect() {
+        detachFromScheduler();
+        saveSession();
+    }
+
+    // Play the other node, both rackets are driven by netStep() from then
+    // on.  Falls back to a local game if the socket can't be set up.
+    void startNetplay(const FPPArcadeNetplayOptions &o) {
+        net = std::make_unique<FPPArcadeNetplay>(o, this, this, timer);
+        if (!net->isValid()) {
+            net.reset();
+            return;
+        }
+        ai[0].enabled = false;
+        ai[1].enabled = false;
+        racketP1Speed = racketP2Speed = 0;
+        // it's in the state hash, so both nodes need the same one
+        rng.seed(1);
+        keepSession = false;
+    }
+    bool canPause() const override {
+        return !net;
+    }
+    // 0 still, 1 up, 2 down
+    uint8_t netInput(uint8_t current, const std::string &button) override {
+        int p1 = UNTOUCHED;
+        int p2 = UNTOUCHED;
+        // either player's buttons move our own racket
+        paddleButton(button, p1, p2);
+        int s = p1 != UNTOUCHED ? p1 : p2;
+        if (s == UNTOUCHED) {
+            return current;
+        }
+        return s < 0 ? 1 : (s > 0 ? 2 : 0);
+    }
+    void netStep(const uint8_t *inputs) override {
+        static constexpr int SPEEDS[3] = {0, -1, 1};
+        racketP1Speed = SPEEDS[inputs[0] % 3];
+        racketP2Speed = SPEEDS[inputs[1] % 3];
+        moveRackets();
+        moveBall();
     }
     
     
     void CopyToModel() {
-        model->clearOverlayBuffer();
+        clear();
         char buf[25];
         sprintf(buf, "%d:%d", p1Score, p2Score);
-        int len = strlen(buf);
-        float scl = scale;
-        
-        while (((model->getHeight() / scl) < 40) && scl > 1) {
-            scl *= 0.80;
-        }
-        if (scl < 1) {
-            scl = 1;
-        }
-        
-        outputString(buf, (model->getWidth()/2 - len*2) / scl, 0, 128, 128, 128, scl);
+        // at most an eighth of the height and never bigger than the court's
+        // own pixels, only rasterized again when the score changes
+        int scl = FPPArcadeText::fitScale(buf, getWidth() / 2, getHeight() / 8, scale);
+        scoreText.set(buf, color(128, 128, 128), scl);
+        scoreText.draw(canvas.get(), (getWidth() - scoreText.getWidth()) / 2, 0);
         
         for (int y = 0; y < racketSize; y++) {
             outputPixel(0, racketP1Pos + y, 255, 255, 255);
@@ -65,35 +134,113 @@ public:
         return NAME;
     }
 
-    virtual int32_t update() override {
+    virtual int32_t updateGame() override {
+        int32_t next = timer;
         if (GameOn) {
-            moveRackets();
-            moveBall();
+            if (net) {
+                next = net->update();
+            } else {
+                moveRackets();
+                moveBall();
+            }
         }
         CopyToModel();
         if (!GameOn) {
-            model->clearOverlayBuffer();
-            model->flushOverlayBuffer();
+            clear();
+            present();
             
             if (WaitingUntilOutput) {
-                model->setState(PixelOverlayState(PixelOverlayState::PixelState::Disabled));
+                disable();
                 return 0;
             }
             WaitingUntilOutput = true;
             return -1;
         }
-        if (p1Score >= 5 || p2Score >= 5) {
+        if (net && net->getState() == FPPArcadeNetplay::State::Lost) {
+            outputString("LOST", (cols-8)/ 2, rows/2-3);
+            present();
+            GameOn = false;
+            return 2000;
+        }
+        if (net && net->getState() == FPPArcadeNetplay::State::Connecting) {
+            std::string msg = "WAITING FOR PLAYER " + std::to_string(2 - net->getSide());
+            waitText.set(msg, color(255, 255, 0), FPPArcadeText::fitScale(msg, INT_MAX, getHeight() / 4));
+            waitText.drawMarquee(canvas.get(), 0, (getHeight() - waitText.getHeight()) / 2, getWidth(), GetTimeMS());
+            present();
+            return next;
+        }
+        // a networked game is only over once the other node agrees on
+        // every frame up to here
+        if ((p1Score >= 5 || p2Score >= 5) && (!net || net->isConfirmed())) {
             GameOn = false;
             outputString("GAME", (cols-8)/ 2, rows/2-6);
             outputString("OVER", (cols-8)/ 2, rows/2);
-            model->flushOverlayBuffer();
+            present();
             return 2000;
         }
-        model->flushOverlayBuffer();
-        return timer;
+        present();
+        return next;
     }
     
+    // Where the ball will be when it reaches column x.  The walls reflect
+    // it, so the straight line path is folded back into the court rather
+    // than stepping the ball forward frame by frame.
+    float predictY(float x) const {
+        float vx = ballDirX * ballSpeed;
+        float t = (x - ballPosX) / vx;
+        float h = rows - 1;
+        if (vx == 0 || t < 0 || h <= 0) {
+            return rows / 2;
+        }
+        float y = std::fmod(ballPosY + ballDirY * ballSpeed * t, 2 * h);
+        if (y < 0) {
+            y += 2 * h;
+        }
+        return y > h ? 2 * h - y : y;
+    }
+
+    int aiSpeed(AI &a, int side, int pos) {
+        if (std::signbit(ballDirX) != std::signbit(a.lastDirX)) {
+            a.lastDirX = ballDirX;
+            a.replanIn = aiDelay;
+        }
+        if (a.replanIn == 0) {
+            bool coming = side == 0 ? ballDirX < 0 : ballDirX > 0;
+            if (coming) {
+                a.target = predictY(side == 0 ? 1 : cols - 2);
+                if (aiError) {
+                    a.target += (int)(rng() % (2 * aiError + 1)) - aiError;
+                }
+            } else {
+                a.target = rows / 2;
+            }
+        }
+        if (a.replanIn >= 0) {
+            a.replanIn--;
+        }
+        float diff = a.target - (pos + racketSize / 2.0f);
+        return diff > 0.5f ? 1 : (diff < -0.5f ? -1 : 0);
+    }
+
     void moveRackets() {
+        {
+            std::lock_guard<std::mutex> l(inputLock);
+            if (pendingSpeed[0] != UNTOUCHED) {
+                racketP1Speed = pendingSpeed[0];
+                ai[0].enabled = false;
+            }
+            if (pendingSpeed[1] != UNTOUCHED) {
+                racketP2Speed = pendingSpeed[1];
+                ai[1].enabled = false;
+            }
+            pendingSpeed = {UNTOUCHED, UNTOUCHED};
+        }
+        if (ai[0].enabled) {
+            racketP1Speed = aiSpeed(ai[0], 0, racketP1Pos);
+        }
+        if (ai[1].enabled) {
+            racketP2Speed = aiSpeed(ai[1], 1, racketP2Pos);
+        }
         racketP1Pos += racketP1Speed;
         if (racketP1Pos < 0) {
             racketP1Pos = 0;
@@ -177,52 +324,107 @@ public:
     }
     
     void button(const std::string &button) {
+        if (net) {
+            net->button(button);
+            return;
+        }
+        int p1 = UNTOUCHED;
+        int p2 = UNTOUCHED;
+        paddleButton(button, p1, p2);
+        // applied by moveRackets() on the game thread, which is the only
+        // place the speeds and the AI flags change
+        std::lock_guard<std::mutex> l(inputLock);
+        if (p1 != UNTOUCHED) {
+            pendingSpeed[0] = p1;
+        }
+        if (p2 != UNTOUCHED) {
+            pendingSpeed[1] = p2;
+        }
+    }
+    // the racket speeds a button sets, the ones it doesn't touch are left
+    static void paddleButton(int controls, const std::string &button, int &p1, int &p2) {
         if (controls == 2) {
             if (button == "Up/Right - Pressed") {
-                racketP2Speed = -1;
+                p2 = -1;
             } else if (button == "Down/Right - Pressed") {
-                racketP2Speed = 1;
+                p2 = 1;
             } else if (button == "Up/Right - Released" || button == "Down/Right - Released") {
-                racketP2Speed = 0;
+                p2 = 0;
             } else if (button == "Up/Left - Pressed") {
-                racketP1Speed = -1;
+                p1 = -1;
             } else if (button == "Down/Left - Pressed") {
-                racketP1Speed = 1;
+                p1 = 1;
             } else if (button == "Down/Left - Released" || button == "Up/Left - Released") {
-                racketP1Speed = 0;
+                p1 = 0;
             }
         } else if (controls == 3) {
             if (button == "Right - Pressed") {
-                racketP2Speed = -1;
+                p2 = -1;
             } else if (button == "Down - Pressed") {
-                racketP2Speed = 1;
+                p2 = 1;
             } else if (button == "Right - Released" || button == "Down - Released") {
-                racketP2Speed = 0;
+                p2 = 0;
             } else if (button == "Up - Pressed") {
-                racketP1Speed = -1;
+                p1 = -1;
             } else if (button == "Left - Pressed") {
-                racketP1Speed = 1;
+                p1 = 1;
             } else if (button == "Left - Released" || button == "Up - Released") {
-                racketP1Speed = 0;
+                p1 = 0;
             }
         } else {
             if (button == "Left - Pressed") {
-                racketP2Speed = -1;
+                p2 = -1;
             } else if (button == "Right - Pressed") {
-                racketP2Speed = 1;
+                p2 = 1;
             } else if (button == "Right - Released" || button == "Left - Released") {
-                racketP2Speed = 0;
+                p2 = 0;
             } else if (button == "Up - Pressed") {
-                racketP1Speed = -1;
+                p1 = -1;
             } else if (button == "Down - Pressed") {
-                racketP1Speed = 1;
+                p1 = 1;
             } else if (button == "Down - Released" || button == "Up - Released") {
-                racketP1Speed = 0;
+                p1 = 0;
             }
         }
     }
     
+    bool serialize(FPPArcadeSnapshot &s) override {
+        if (!GameOn) {
+            return false;
+        }
+        s.io(ai);
+        s.io(rng);
+        s.io(p1Score);
+        s.io(p2Score);
+        s.io(racketP1Pos);
+        s.io(racketP1Speed);
+        s.io(racketP2Pos);
+        s.io(racketP2Speed);
+        s.io(ballPosX);
+        s.io(ballPosY);
+        s.io(ballDirX);
+        s.io(ballDirY);
+        s.io(ballSpeed);
+        return true;
+    }
+
+    void paddleButton(const std::string &button, int &p1, int &p2) const {
+        paddleButton(controls, button, p1, p2);
+    }
+
     int controls;
+    // a human pressing a paddle's buttons takes it over from the computer,
+    // the speed they set waits here until the next frame
+    static constexpr int UNTOUCHED = 100;
+    std::mutex inputLock;
+    std::array<int, 2> pendingSpeed = {UNTOUCHED, UNTOUCHED};
+    FPPArcadeText scoreText;
+    FPPArcadeText waitText;
+    std::unique_ptr<FPPArcadeNetplay> net;
+    std::array<AI, 2> ai;
+    int aiDelay = 0;
+    int aiError = 0;
+    std::minstd_rand rng{std::random_device{}()};
 
     int rows = 20;
     int cols = 20;
@@ -256,22 +458,27 @@ const std::string &FPPPong::getName() {
 
 
 void FPPPong::button(const std::string &button) {
-    PixelOverlayModel *m = PixelOverlayManager::INSTANCE.getModel(modelName);
+    PongEffect *effect = static_cast<PongEffect*>(getEffect());
+    if (effect) {
+        effect->button(button);
+        return;
+    }
+    PixelOverlayModel *m = resolveModel();
     if (m != nullptr) {
-        PongEffect *effect = dynamic_cast<PongEffect*>(m->getRunningEffect());
-        if (!effect) {
-            if (findOption("overlay", "Overwrite") == "Transparent") {
-                m->setState(PixelOverlayState(PixelOverlayState::PixelState::TransparentRGB));
-            } else {
-                m->setState(PixelOverlayState(PixelOverlayState::PixelState::Enabled));
-            }
-            int controls = std::stoi(findOption("Controls", "1"));
-            int pixelScaling = std::stoi(findOption("Pixel Scaling", "1"));
-            effect = new PongEffect(pixelScaling, controls, m);
-            effect->button(button);
-            m->setRunningEffect(effect, 50);
+        FPPArcadeCanvas *canvas = createCanvas(m);
+        effect = new PongEffect(getOptions().pixelScaling, getOptions(), canvas);
+        if (getOptions().netplay.enabled) {
+            effect->startNetplay(getOptions().netplay);
         } else {
             effect->button(button);
         }
+        startEffect(effect);
     }
 }
+
+FPPArcadeGameEffect *FPPPong::createDemo(FPPArcadeCanvas *c) {
+    PongEffect *e = new PongEffect(getOptions().pixelScaling, getOptions(), c);
+    e->ai[0].enabled = true;
+    e->ai[1].enabled = true;
+    return e;
+}
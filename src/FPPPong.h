@@ -2,15 +2,37 @@
 #define __FPPARCADE_PONG_
 
 #include "FPPArcade.h"
+#include "FPPArcadeNetplay.h"
+
+class FPPPongOptions : public FPPArcadeGameOptions {
+public:
+    FPPPongOptions(const Json::Value &config);
+
+    int pixelScaling;
+    int controls;
+    // "Human", "Computer" (right paddle) or "Attract" (both paddles)
+    std::string opponent;
+    // ms the computer waits after the ball turns before reacting
+    int aiReaction;
+    // max pixels the computer's aim is off by
+    int aiError;
+    // one paddle each on two nodes, overrides the opponent
+    FPPArcadeNetplayOptions netplay;
+};
 
 class FPPPong : public FPPArcadeGame {
 public:
-    FPPPong(Json::Value &config);
+    FPPPong(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options);
     virtual ~FPPPong();
     
     virtual const std::string &getName() override;
     
     virtual void button(const std::string &button) override;
+
+    const FPPPongOptions &getOptions() const { return static_cast<const FPPPongOptions&>(*options); }
+
+protected:
+    virtual FPPArcadeGameEffect *createDemo(FPPArcadeCanvas *c) override;
 };
 
 
@@ -1,7 +1,9 @@
 #include <fpp-pch.h>
 
 #include "FPPSnake.h"
+#include "FPPArcadeSnapshot.h"
 #include <array>
+#include <climits>
 #include <random>
 
 #include "overlays/PixelOverlay.h"
@@ -9,7 +11,13 @@
 #include "overlays/PixelOverlayEffects.h"
 
 
-FPPSnake::FPPSnake(Json::Value &config) : FPPArcadeGame(config) {
+FPPSnakeOptions::FPPSnakeOptions(const Json::Value &config) : FPPArcadeGameOptions(config) {
+    pixelScaling = intOption(config, "Pixel Scaling", 1, 1, 20);
+}
+
+static FPPArcadeGameRegistration<FPPSnake, FPPSnakeOptions> registration("Snake");
+
+FPPSnake::FPPSnake(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options) : FPPArcadeGame(config, options) {
     std::srand(time(NULL));
 }
 FPPSnake::~FPPSnake() {
@@ -17,8 +25,8 @@ FPPSnake::~FPPSnake() {
 
 class SnakeEffect : public FPPArcadeGameEffect {
 public:
-    SnakeEffect(int sc, PixelOverlayModel *m) : FPPArcadeGameEffect(m) {
-        m->getSize(cols, rows);
+    SnakeEffect(int sc, FPPArcadeCanvas *cv) : FPPArcadeGameEffect(cv) {
+        getSize(cols, rows);
         scale = sc;
         cols /= sc;
         rows /= sc;
@@ -36,6 +44,8 @@ public:
         addFood();
     }
     ~SnakeEffect() {
+        detachFromScheduler();
+        saveSession();
     }
     
     void addFood() {
@@ -65,7 +75,7 @@ public:
 
     
     void CopyToModel() {
-        model->clearOverlayBuffer();
+        clear();
         for (auto &a : food) {
             outputPixel(a.first, a.second, 0, 255, 0);
         }
@@ -93,6 +103,47 @@ public:
         }
     }
     
+    bool isFree(int x, int y) const {
+        if (x <= 0 || y <= 0 || x >= (cols - 1) || y >= (rows - 1)) {
+            return false;
+        }
+        for (auto &a : snake) {
+            if (a.first == x && a.second == y) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // attract mode, head for the closest food without hitting anything
+    void steer() {
+        static const int DX[4] = {-1, 0, 1, 0};
+        static const int DY[4] = {0, -1, 0, 1};
+        int best = -1;
+        int bestDist = INT_MAX;
+        for (int d = 0; d < 4; d++) {
+            if (d == ((direction + 2) & 3)) {
+                continue;
+            }
+            int x = snake.front().first + DX[d];
+            int y = snake.front().second + DY[d];
+            if (!isFree(x, y)) {
+                continue;
+            }
+            int dist = INT_MAX;
+            for (auto &a : food) {
+                dist = std::min(dist, std::abs(a.first - x) + std::abs(a.second - y));
+            }
+            if (dist < bestDist) {
+                bestDist = dist;
+                best = d;
+            }
+        }
+        if (best >= 0) {
+            direction = best;
+        }
+    }
+
     void moveSnake() {
         int x = snake.front().first;
         int y = snake.front().second;
@@ -128,6 +179,7 @@ public:
         } else {
             food.remove({x, y});
             addFood();
+            burst(x, y, 10, 0, 255, 0, 6, 500);
         }
         snake.push_front({x, y});
         if (x == 0 || y == 0 || x == (cols-1) || y == (rows-1)) {
@@ -137,35 +189,46 @@ public:
         
     }
     
-    virtual int32_t update() override {
+    virtual int32_t updateGame() override {
+        if (enteringInitials()) {
+            return updateInitials();
+        }
         if (!GameOn) {
             if (WaitingUntilOutput) {
-                model->setState(PixelOverlayState(PixelOverlayState::PixelState::Disabled));
+                disable();
                 return 0;
             }
-            model->clearOverlayBuffer();
-            model->flushOverlayBuffer();
+            clear();
+            present();
             WaitingUntilOutput = true;
             return -1;
         }
+        if (demo) {
+            steer();
+        }
         moveSnake();
         CopyToModel();
         if (!GameOn) {
             GameOn = false;
+            burst(snake.front().first, snake.front().second, 30, 255, 64, 0, 10, 900);
             outputString("GAME", cols/ 2 - 8, rows/2-9);
             outputString("OVER", cols/ 2 - 8, rows/2-3);
             char buf[25];
             sprintf(buf, "%d", (uint32_t)snake.size());
             outputString(buf, (cols)/ 2 - 4, rows/2+3);
-            model->flushOverlayBuffer();
+            gameOver(snake.size());
+            present();
             return 2000;
         }
-        model->flushOverlayBuffer();
+        present();
         return timer;
     }
     
     
     void button(const std::string &button) {
+        if (initialsButton(button)) {
+            return;
+        }
         if (button == "Left - Pressed") {
             direction = 0;
         } else if (button == "Right - Pressed") {
@@ -178,6 +241,17 @@ public:
     }
     
     
+    bool serialize(FPPArcadeSnapshot &s) override {
+        if (!GameOn) {
+            return false;
+        }
+        s.io(food);
+        s.io(snake);
+        s.io(direction);
+        s.io(timer);
+        return true;
+    }
+
     std::list<std::pair<int, int>> food;
     std::list<std::pair<int, int>> snake;
     int direction = 0;
@@ -196,20 +270,19 @@ const std::string &FPPSnake::getName() {
 
 
 void FPPSnake::button(const std::string &button) {
-    PixelOverlayModel *m = PixelOverlayManager::INSTANCE.getModel(modelName);
+    SnakeEffect *effect = static_cast<SnakeEffect*>(getEffect());
+    if (effect) {
+        effect->button(button);
+        return;
+    }
+    PixelOverlayModel *m = resolveModel();
     if (m != nullptr) {
-        SnakeEffect *effect = dynamic_cast<SnakeEffect*>(m->getRunningEffect());
-        if (!effect) {
-            if (findOption("overlay", "Overwrite") == "Transparent") {
-                m->setState(PixelOverlayState(PixelOverlayState::PixelState::TransparentRGB));
-            } else {
-                m->setState(PixelOverlayState(PixelOverlayState::PixelState::Enabled));
-            }
-            int pixelScaling = std::stoi(findOption("Pixel Scaling", "1"));
-            effect = new SnakeEffect(pixelScaling, m);
-            m->setRunningEffect(effect, 50);
-        } else {
-            effect->button(button);
-        }
+        FPPArcadeCanvas *canvas = createCanvas(m);
+        effect = new SnakeEffect(getOptions().pixelScaling, canvas);
+        startEffect(effect);
     }
 }
+
+FPPArcadeGameEffect *FPPSnake::createDemo(FPPArcadeCanvas *c) {
+    return new SnakeEffect(getOptions().pixelScaling, c);
+}
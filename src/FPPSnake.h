@@ -3,14 +3,26 @@
 
 #include "FPPArcade.h"
 
+class FPPSnakeOptions : public FPPArcadeGameOptions {
+public:
+    FPPSnakeOptions(const Json::Value &config);
+
+    int pixelScaling;
+};
+
 class FPPSnake : public FPPArcadeGame {
 public:
-    FPPSnake(Json::Value &config);
+    FPPSnake(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options);
     virtual ~FPPSnake();
 
     virtual const std::string &getName() override;
 
     virtual void button(const std::string &button) override;
+
+    const FPPSnakeOptions &getOptions() const { return static_cast<const FPPSnakeOptions&>(*options); }
+
+protected:
+    virtual FPPArcadeGameEffect *createDemo(FPPArcadeCanvas *c) override;
 };
 
 
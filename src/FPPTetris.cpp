@@ -1,7 +1,9 @@
 #include <fpp-pch.h>
 
 #include "FPPTetris.h"
+#include "FPPArcadeSnapshot.h"
 #include <array>
+#include <mutex>
 #include <random>
 
 #include "overlays/PixelOverlay.h"
@@ -9,7 +11,15 @@
 #include "overlays/PixelOverlayEffects.h"
 
 
-FPPTetris::FPPTetris(Json::Value &config) : FPPArcadeGame(config) {
+FPPTetrisOptions::FPPTetrisOptions(const Json::Value &config) : FPPArcadeGameOptions(config) {
+    pixelScaling = intOption(config, "Pixel Scaling", 1, 1, 20);
+    rows = intOption(config, "Rows", 20, 1, 50);
+    cols = intOption(config, "Colums", 11, 1, 30);
+}
+
+static FPPArcadeGameRegistration<FPPTetris, FPPTetrisOptions> registration("Tetris");
+
+FPPTetris::FPPTetris(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options) : FPPArcadeGame(config, options) {
     std::srand(time(NULL));
 }
 FPPTetris::~FPPTetris() {
@@ -58,8 +68,8 @@ public:
     
     int getWidth() { return width;}
 
-    uint32_t getColor() {
-        return COLORS[type];
+    int getType() const {
+        return type;
     }
 private:
     void setRandomShape() {
@@ -129,7 +139,7 @@ private:
 
 class TetrisEffect : public FPPArcadeGameEffect {
 public:
-    TetrisEffect(int r, int c, int offx, int offy, int sc, PixelOverlayModel *m) : FPPArcadeGameEffect(m), rows(r), cols(c) {
+    TetrisEffect(int r, int c, int offx, int offy, int sc, FPPArcadeCanvas *cv) : FPPArcadeGameEffect(cv), rows(r), cols(c) {
         table.resize(r);
         for (int x = 0; x < r; x++) {
             table[x].resize(c);
@@ -137,10 +147,16 @@ public:
         scale = sc;
         offsetX = offx;
         offsetY = offy;
+        for (int x = 0; x < COLORS.size(); x++) {
+            shapeColors[x] = color((COLORS[x] >> 16) & 0xFF, (COLORS[x] >> 8) & 0xFF, COLORS[x] & 0xFF);
+        }
+        borderColor = color(128, 128, 128);
         newShape();
         CopyToModel();
     }
     ~TetrisEffect() {
+        detachFromScheduler();
+        saveSession();
         if (currentShape) {
             delete currentShape;
         }
@@ -179,7 +195,7 @@ public:
         for (int i = 0; i < currentShape->getWidth(); i++) {
             for (int j = 0; j < currentShape->getWidth(); j++) {
                 if (currentShape->get(i, j)) {
-                    table[currentShape->row+i][currentShape->col+j] = currentShape->getColor();
+                    table[currentShape->row+i][currentShape->col+j] = shapeColors[currentShape->getType()];
                 }
             }
         }
@@ -196,6 +212,10 @@ public:
             }
             if (sum == cols){
                 score++;
+                // the line goes up in sparks of its own colors
+                for (int l = 0; l < cols; l++) {
+                    burstIndex(l, i, 2, table[i][l], 6, 700);
+                }
 
                 for (int k = i; k >= 1; k--) {
                     for (int l = 0; l < cols; l++) {
@@ -214,53 +234,50 @@ public:
     }
     
     void CopyToModel() {
-        model->clearOverlayBuffer();
+        clear();
         if (offsetX) {
             for (int y = 0; y < rows*scale; y++) {
-                model->setOverlayPixelValue(offsetX-1, offsetY + y, 128, 128, 128);
-                model->setOverlayPixelValue(offsetX+cols*scale, offsetY + y, 128, 128, 128);
+                setPixel(offsetX-1, offsetY + y, borderColor);
+                setPixel(offsetX+cols*scale, offsetY + y, borderColor);
             }
             for (int x = -1; x <= cols*scale; x++) {
-                model->setOverlayPixelValue(offsetX+x, offsetY + rows*scale, 128, 128, 128);
+                setPixel(offsetX+x, offsetY + rows*scale, borderColor);
                 if (offsetY) {
-                    model->setOverlayPixelValue(offsetX+x, offsetY - 1, 128, 128, 128);
+                    setPixel(offsetX+x, offsetY - 1, borderColor);
                 }
             }
         }
         for(int i = 0; i < rows; i++) {
             for(int j = 0; j < cols; j++) {
                 if (table[i][j]) {
-                    int r = (table[i][j] >> 16) & 0xFF;
-                    int g = (table[i][j] >> 8) & 0xFF;
-                    int b = (table[i][j]) & 0xFF;
-                    outputPixel(j, i, r, g, b);
+                    outputPixel(j, i, table[i][j]);
                 }
             }
         }
         if (currentShape) {
-            uint32_t color = currentShape->getColor();
-            int r = (color >> 16) & 0xFF;
-            int g = (color >> 8) & 0xFF;
-            int b = (color) & 0xFF;
+            uint8_t c = shapeColors[currentShape->getType()];
 
             for (int i = 0; i < currentShape->getWidth(); i++) {
                 for (int j = 0; j < currentShape->getWidth(); j++) {
                     if (currentShape->get(i, j)) {
-                        outputPixel(currentShape->col+j, currentShape->row+i, r, g, b);
+                        outputPixel(currentShape->col+j, currentShape->row+i, c);
                     }
                 }
             }
 
         }
-        model->flushOverlayBuffer();
+        present();
     }
     
-    virtual int32_t update() override {
+    virtual int32_t updateGame() override {
+        if (enteringInitials()) {
+            return updateInitials();
+        }
         if (!GameOn) {
             if (currentShape) {
                 delete currentShape;
                 currentShape = nullptr;
-                model->clearOverlayBuffer();
+                clear();
                 outputLetter(0, 0, 'G');
                 outputLetter(4, 0, 'A');
                 outputLetter(8, 0, 'M');
@@ -282,25 +299,57 @@ public:
                     x += 4;
                     b2++;
                 }
+                gameOver(score);
 
-                model->flushOverlayBuffer();
+                present();
                 return 3000;
             }
-            model->clearOverlayBuffer();
-            model->flushOverlayBuffer();
+            clear();
+            present();
             
             if (WaitingUntilOutput) {
-                model->setState(PixelOverlayState(PixelOverlayState::PixelState::Disabled));
+                disable();
                 return 0;
             }
             WaitingUntilOutput = true;
             return -1;
         }
-        button("Down - Pressed");
-        return timer;
+        {
+            // presses come from the input thread, the shape and the table
+            // are only touched here
+            std::lock_guard<std::mutex> l(inputLock);
+            moves.swap(pendingMoves);
+        }
+        bool changed = !moves.empty();
+        for (auto &m : moves) {
+            move(m);
+        }
+        moves.clear();
+        long long now = GetTimeMS();
+        if (now >= nextDrop) {
+            move("Down - Pressed");
+            nextDrop = now + timer;
+            changed = true;
+        }
+        if (changed) {
+            CopyToModel();
+        }
+        // polled so presses show up quickly, the shape only falls every timer ms
+        return std::min(INPUT_POLL_MS, (int32_t)std::max(1LL, nextDrop - now));
     }
-    
+
     void button(const std::string &button) {
+        if (initialsButton(button)) {
+            return;
+        }
+        if (button == "Left - Pressed" || button == "Right - Pressed" ||
+            button == "Up - Pressed" || button == "Down - Pressed") {
+            std::lock_guard<std::mutex> l(inputLock);
+            pendingMoves.push_back(button);
+        }
+    }
+
+    void move(const std::string &button) {
         if (!GameOn) {
             return;
         }
@@ -332,20 +381,40 @@ public:
         //} else {
             //printf("Unknown -%s-\n", button.c_str());
         }
-        CopyToModel();
     }
     
     
 
+    bool serialize(FPPArcadeSnapshot &s) override {
+        if (!GameOn || currentShape == nullptr) {
+            return false;
+        }
+        s.io(table);
+        s.io(*currentShape);
+        s.io(score);
+        s.io(timer);
+        return true;
+    }
+
     int rows = 20;
     int cols = 11;
-    std::vector<std::vector<uint32_t>> table;
+    // palette index per cell, 0 is empty
+    std::vector<std::vector<uint8_t>> table;
+    std::array<uint8_t, 7> shapeColors;
+    uint8_t borderColor = 0;
     int score = 0;
     bool GameOn = true;
     bool WaitingUntilOutput = false;
     
     Shape *currentShape = nullptr;
     long long timer = 500; //half second
+    long long nextDrop = 0;
+
+    static constexpr int32_t INPUT_POLL_MS = 20;
+    std::mutex inputLock;
+    std::vector<std::string> pendingMoves;
+    // only used by updateGame(), swapped with pendingMoves
+    std::vector<std::string> moves;
 
 };
 
@@ -356,31 +425,28 @@ const std::string &FPPTetris::getName() {
 
 
 void FPPTetris::button(const std::string &button) {
-    PixelOverlayModel *m = PixelOverlayManager::INSTANCE.getModel(modelName);
+    TetrisEffect *effect = static_cast<TetrisEffect*>(getEffect());
+    if (effect) {
+        effect->button(button);
+        return;
+    }
+    PixelOverlayModel *m = resolveModel();
     if (m != nullptr) {
-        TetrisEffect *effect = dynamic_cast<TetrisEffect*>(m->getRunningEffect());
-        if (!effect) {
-            if (findOption("overlay", "Overwrite") == "Transparent") {
-                m->setState(PixelOverlayState(PixelOverlayState::PixelState::TransparentRGB));
-            } else {
-                m->setState(PixelOverlayState(PixelOverlayState::PixelState::Enabled));
-            }
-            int pixelScaling = std::stoi(findOption("Pixel Scaling", "1"));
-            int rows = std::stoi(findOption("Rows", "20"));
-            int cols = std::stoi(findOption("Colums", "11"));
-            int offsetX = (m->getWidth() - (cols * pixelScaling)) / 2;
-            if (offsetX < 0) {
-                offsetX = 0;
-            }
-            int offsetY = (m->getHeight() - (rows * pixelScaling)) / 2;
-            if (offsetY < 0) {
-                offsetY = 0;
-            }
-            effect = new TetrisEffect(rows, cols, offsetX, offsetY, pixelScaling, m);
-            effect->button(button);
-            m->setRunningEffect(effect, 50);
-        } else {
-            effect->button(button);
+        FPPArcadeCanvas *canvas = createCanvas(m);
+        const FPPTetrisOptions &o = getOptions();
+        int pixelScaling = o.pixelScaling;
+        int rows = o.rows;
+        int cols = o.cols;
+        int offsetX = (canvas->getWidth() - (cols * pixelScaling)) / 2;
+        if (offsetX < 0) {
+            offsetX = 0;
+        }
+        int offsetY = (canvas->getHeight() - (rows * pixelScaling)) / 2;
+        if (offsetY < 0) {
+            offsetY = 0;
         }
+        effect = new TetrisEffect(rows, cols, offsetX, offsetY, pixelScaling, canvas);
+        effect->button(button);
+        startEffect(effect);
     }
 }
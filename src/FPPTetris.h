@@ -3,14 +3,25 @@
 
 #include "FPPArcade.h"
 
+class FPPTetrisOptions : public FPPArcadeGameOptions {
+public:
+    FPPTetrisOptions(const Json::Value &config);
+
+    int pixelScaling;
+    int rows;
+    int cols;
+};
+
 class FPPTetris : public FPPArcadeGame {
 public:
-    FPPTetris(Json::Value &config);
+    FPPTetris(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options);
     virtual ~FPPTetris();
     
     virtual const std::string &getName() override;
     
     virtual void button(const std::string &button) override;
+
+    const FPPTetrisOptions &getOptions() const { return static_cast<const FPPTetrisOptions&>(*options); }
 };
 
 
@@ -0,0 +1,517 @@
+#include <fpp-pch.h>
+
+#include "FPPTron.h"
+#include "FPPArcadeSnapshot.h"
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <random>
+
+#include "overlays/PixelOverlay.h"
+#include "overlays/PixelOverlayModel.h"
+#include "overlays/PixelOverlayEffects.h"
+
+
+FPPTronOptions::FPPTronOptions(const Json::Value &config) : FPPArcadeGameOptions(config) {
+    pixelScaling = intOption(config, "Pixel Scaling", 1, 1, 20);
+    players = intOption(config, "Players", 2, 1, FPPArcadeGame::MAX_PLAYERS);
+    speed = intOption(config, "Speed", 40, 10, 500);
+    rounds = intOption(config, "Rounds", 3, 1, 20);
+    netplayOptions(config, netplay);
+    if (netplay.enabled) {
+        players = 2;
+    }
+}
+
+static FPPArcadeGameRegistration<FPPTron, FPPTronOptions> registration("Tron");
+
+FPPTron::FPPTron(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options) : FPPArcadeGame(config, options) {
+}
+FPPTron::~FPPTron() {
+}
+
+static const int CYCLE_COLORS[FPPArcadeGame::MAX_PLAYERS][3] = {
+    {0, 128, 255}, {255, 128, 0}, {0, 255, 0}, {255, 0, 255},
+    {255, 255, 0}, {0, 255, 255}, {255, 0, 0}, {160, 160, 255}
+};
+static const int DX[4] = {-1, 0, 1, 0};
+static const int DY[4] = {0, -1, 0, 1};
+
+// The arena is an occupancy bitmap, one bit a cell, so testing a move is a
+// single bit lookup no matter how long the trails get.  The picture is
+// drawn incrementally: the canvas keeps the trails from frame to frame and
+// each tick only touches the cells that changed.
+class TronEffect : public FPPArcadeGameEffect, public FPPArcadeNetGame {
+public:
+    class Cycle {
+    public:
+        int x = 0;
+        int y = 0;
+        int dir = 0;
+        bool alive = true;
+        int wins = 0;
+        // turns pressed since the last move, so quick double taps work
+        std::array<int, 2> pending;
+        int pendingCount = 0;
+        // cell indexes, to erase the trail when the cycle crashes
+        std::vector<uint32_t> trail;
+        uint8_t headColor = 0;
+        uint8_t trailColor = 0;
+
+        void serialize(FPPArcadeSnapshot &s) {
+            s.io(x);
+            s.io(y);
+            s.io(dir);
+            s.io(alive);
+            s.io(wins);
+            s.io(pending);
+            s.io(pendingCount);
+            s.io(trail);
+            s.io(headColor);
+            s.io(trailColor);
+        }
+    };
+
+    TronEffect(const FPPTronOptions &o, FPPArcadeCanvas *cv) : FPPArcadeGameEffect(cv), speed(o.speed), rounds(o.rounds) {
+        getSize(cols, rows);
+        scale = o.pixelScaling;
+        cols /= scale;
+        rows /= scale;
+        offsetX = 0;
+        offsetY = 0;
+
+        stride = (cols + 63) / 64;
+        occupied.resize(stride * rows);
+        cycles.resize(o.players);
+        for (int x = 0; x < cycles.size(); x++) {
+            const int *c = CYCLE_COLORS[x];
+            cycles[x].headColor = color(255, 255, 255);
+            cycles[x].trailColor = color(c[0], c[1], c[2]);
+        }
+        wallColor = color(64, 64, 64);
+        startRound();
+    }
+    ~TronEffect() {
+        detachFromScheduler();
+        saveSession();
+    }
+
+    // Play the other node, side 0 is the first cycle.  Everything then
+    // runs in netStep() frames of "speed" ms, including the pauses
+    // between rounds.  Falls back to a local game if the socket can't be
+    // set up.
+    void startNetplay(const FPPArcadeNetplayOptions &o) {
+        net = std::make_unique<FPPArcadeNetplay>(o, this, this, speed);
+        if (!net->isValid()) {
+            net.reset();
+            return;
+        }
+        // it's in the state hash, so both nodes need the same one
+        rng.seed(1);
+        keepSession = false;
+    }
+    bool canPause() const override {
+        return !net;
+    }
+    // 4 | direction of the last turn pressed, bit 3 flips on every press
+    // so pressing the same direction twice is two turns
+    uint8_t netInput(uint8_t current, const std::string &button) override {
+        int dir = buttonDirection(button);
+        if (dir < 0) {
+            return current;
+        }
+        return ((current & 8) ^ 8) | 4 | dir;
+    }
+    void netStep(const uint8_t *inputs) override {
+        if (matchOver) {
+            return;
+        }
+        for (int i = 0; i < 2; i++) {
+            if (inputs[i] == netLast[i]) {
+                continue;
+            }
+            netLast[i] = inputs[i];
+            Cycle &c = cycles[i];
+            int dir = inputs[i] & 3;
+            if ((inputs[i] & 4) && dir != ((c.dir + 2) & 3)) {
+                c.dir = dir;
+            }
+        }
+        if (netWait > 0) {
+            netWait--;
+            return;
+        }
+        netWait = std::max(advance() / speed - 1, 0);
+    }
+
+    const std::string &name() const override {
+        static std::string NAME = "Tron";
+        return NAME;
+    }
+
+    bool isOccupied(int x, int y) const {
+        return (occupied[y * stride + (x >> 6)] >> (x & 63)) & 1;
+    }
+    void setOccupied(int x, int y, bool b) {
+        uint64_t bit = 1ULL << (x & 63);
+        if (b) {
+            occupied[y * stride + (x >> 6)] |= bit;
+        } else {
+            occupied[y * stride + (x >> 6)] &= ~bit;
+        }
+    }
+
+    void startRound() {
+        std::fill(occupied.begin(), occupied.end(), 0);
+        clear();
+        for (int x = 0; x < cols; x++) {
+            setOccupied(x, 0, true);
+            setOccupied(x, rows - 1, true);
+            outputPixel(x, 0, wallColor);
+            outputPixel(x, rows - 1, wallColor);
+        }
+        for (int y = 0; y < rows; y++) {
+            setOccupied(0, y, true);
+            setOccupied(cols - 1, y, true);
+            outputPixel(0, y, wallColor);
+            outputPixel(cols - 1, y, wallColor);
+        }
+        // spread the cycles around an ellipse, each heading along the
+        // tangent so nobody starts pointed at anybody else
+        std::lock_guard<std::mutex> l(inputLock);
+        int n = cycles.size();
+        for (int i = 0; i < n; i++) {
+            Cycle &c = cycles[i];
+            float a = 2.0f * M_PI * i / n + M_PI;
+            float fx = std::cos(a);
+            float fy = std::sin(a);
+            c.x = std::clamp((int)std::lround(cols / 2 + fx * cols * 0.35f), 1, cols - 2);
+            c.y = std::clamp((int)std::lround(rows / 2 + fy * rows * 0.35f), 1, rows - 2);
+            if (std::fabs(fx) > std::fabs(fy)) {
+                c.dir = fx < 0 ? 1 : 3;
+            } else {
+                c.dir = fy < 0 ? 2 : 0;
+            }
+            c.alive = true;
+            c.pendingCount = 0;
+            c.trail.clear();
+            c.trail.push_back(c.y * cols + c.x);
+            setOccupied(c.x, c.y, true);
+            outputPixel(c.x, c.y, c.headColor);
+        }
+        aliveCount = n;
+    }
+
+    void crash(Cycle &c) {
+        c.alive = false;
+        aliveCount--;
+        for (auto t : c.trail) {
+            int x = t % cols;
+            int y = t / cols;
+            setOccupied(x, y, false);
+            outputPixel(x, y, (uint8_t)0);
+        }
+        c.trail.clear();
+    }
+
+    // free cells straight ahead in direction d, up to max
+    int freeRun(const Cycle &c, int d, int max) const {
+        int x = c.x;
+        int y = c.y;
+        for (int r = 0; r < max; r++) {
+            x += DX[d];
+            y += DY[d];
+            if (isOccupied(x, y)) {
+                return r;
+            }
+        }
+        return max;
+    }
+
+    // attract mode: turn toward the more open side when blocked, and now
+    // and then just because
+    void steer(Cycle &c) {
+        int ahead = freeRun(c, c.dir, 8);
+        if (ahead >= 8 && rng() % 40 != 0) {
+            return;
+        }
+        int left = (c.dir + 3) & 3;
+        int right = (c.dir + 1) & 3;
+        int l = freeRun(c, left, 64);
+        int r = freeRun(c, right, 64);
+        int best = l >= r ? left : right;
+        if (std::max(l, r) > ahead) {
+            c.dir = best;
+        }
+    }
+
+    // Every cycle picks its next cell from the arena as it was before this
+    // tick, then all the moves are applied at once, so the result doesn't
+    // depend on the order the players are processed in.
+    void moveCycles() {
+        int n = cycles.size();
+        std::array<int, FPPArcadeGame::MAX_PLAYERS> nx;
+        std::array<int, FPPArcadeGame::MAX_PLAYERS> ny;
+        std::array<bool, FPPArcadeGame::MAX_PLAYERS> dies;
+        {
+            std::lock_guard<std::mutex> l(inputLock);
+            for (auto &c : cycles) {
+                if (c.alive && c.pendingCount) {
+                    c.dir = c.pending[0];
+                    c.pending[0] = c.pending[1];
+                    c.pendingCount--;
+                }
+            }
+        }
+        if (demo) {
+            for (auto &c : cycles) {
+                if (c.alive) {
+                    steer(c);
+                }
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            Cycle &c = cycles[i];
+            dies[i] = false;
+            if (!c.alive) {
+                continue;
+            }
+            nx[i] = c.x + DX[c.dir];
+            ny[i] = c.y + DY[c.dir];
+            dies[i] = isOccupied(nx[i], ny[i]);
+        }
+        // head on into the same cell takes out both
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                if (cycles[i].alive && cycles[j].alive && nx[i] == nx[j] && ny[i] == ny[j]) {
+                    dies[i] = true;
+                    dies[j] = true;
+                }
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            Cycle &c = cycles[i];
+            if (!c.alive) {
+                continue;
+            }
+            if (dies[i]) {
+                crash(c);
+                continue;
+            }
+            outputPixel(c.x, c.y, c.trailColor);
+            c.x = nx[i];
+            c.y = ny[i];
+            c.trail.push_back(c.y * cols + c.x);
+            setOccupied(c.x, c.y, true);
+            outputPixel(c.x, c.y, c.headColor);
+        }
+    }
+
+    void showWinner(int w) {
+        clear();
+        if (w >= 0) {
+            const int *c = CYCLE_COLORS[w];
+            outputString(std::to_string(w + 1), cols / 2 - 2, rows / 2 - 3, c[0], c[1], c[2]);
+        }
+        // the score line, one dot per round won
+        for (int i = 0; i < cycles.size(); i++) {
+            for (int r = 0; r < cycles[i].wins; r++) {
+                outputPixel(2 + r * 2, 2 + i * 2, cycles[i].trailColor);
+            }
+        }
+    }
+
+    virtual int32_t updateGame() override {
+        if (!GameOn) {
+            if (WaitingUntilOutput) {
+                disable();
+                return 0;
+            }
+            clear();
+            present();
+            WaitingUntilOutput = true;
+            return -1;
+        }
+        if (net) {
+            return updateNet();
+        }
+        int32_t next = advance();
+        if (matchOver) {
+            GameOn = false;
+        }
+        present();
+        return next;
+    }
+
+    int32_t updateNet() {
+        int32_t next = net->update();
+        FPPArcadeNetplay::State st = net->getState();
+        if (st == FPPArcadeNetplay::State::Running && !netStarted) {
+            // wipe the WAIT
+            netStarted = true;
+            startRound();
+        }
+        if (st != FPPArcadeNetplay::State::Running) {
+            bool lost = st == FPPArcadeNetplay::State::Lost;
+            outputString(lost ? "LOST" : "WAIT", cols / 2 - 8, rows / 2 - 3);
+            present();
+            if (lost) {
+                GameOn = false;
+                return 2000;
+            }
+            return next;
+        }
+        present();
+        // keep exchanging inputs until the other node agrees on the end
+        if (matchOver && net->isConfirmed()) {
+            GameOn = false;
+            return 2000;
+        }
+        return next;
+    }
+
+    // One move, or the start of the next round.  Returns the ms until
+    // the next one.
+    int32_t advance() {
+        if (betweenRounds) {
+            betweenRounds = false;
+            startRound();
+            return 1000;
+        }
+        moveCycles();
+        // one player left standing wins the round, a solo player just
+        // plays until they crash
+        int over = cycles.size() > 1 ? 1 : 0;
+        if (aliveCount <= over) {
+            int winner = -1;
+            for (int i = 0; i < cycles.size(); i++) {
+                if (cycles[i].alive) {
+                    winner = i;
+                    cycles[i].wins++;
+                }
+            }
+            showWinner(winner);
+            if (winner >= 0 && cycles[winner].wins >= rounds) {
+                outputString("GAME", cols / 2 - 8, rows / 2 - 9);
+                outputString("OVER", cols / 2 - 8, rows / 2 + 3);
+                matchOver = true;
+            } else if (cycles.size() == 1) {
+                matchOver = true;
+            }
+            betweenRounds = true;
+            return 2000;
+        }
+        return speed;
+    }
+
+    static int buttonDirection(const std::string &button) {
+        if (button == "Left - Pressed") {
+            return 0;
+        } else if (button == "Up - Pressed") {
+            return 1;
+        } else if (button == "Right - Pressed") {
+            return 2;
+        } else if (button == "Down - Pressed") {
+            return 3;
+        }
+        return -1;
+    }
+
+    // Up/Down/Left/Right - Pressed turn player's cycle, reversing onto
+    // its own trail is ignored
+    void button(int player, const std::string &button) {
+        if (net) {
+            // whichever controller it is, it drives this node's cycle
+            net->button(button);
+            return;
+        }
+        int dir = buttonDirection(button);
+        // unbound controllers drive the first cycle
+        int idx = player > 0 ? player - 1 : 0;
+        if (dir < 0 || idx >= cycles.size()) {
+            return;
+        }
+        std::lock_guard<std::mutex> l(inputLock);
+        Cycle &c = cycles[idx];
+        int last = c.pendingCount ? c.pending[c.pendingCount - 1] : c.dir;
+        if (dir == last || dir == ((last + 2) & 3) || c.pendingCount == 2) {
+            return;
+        }
+        c.pending[c.pendingCount++] = dir;
+    }
+
+    // the trails are only in the canvas, which the base snapshots too
+    bool serialize(FPPArcadeSnapshot &s) override {
+        if (!GameOn) {
+            return false;
+        }
+        s.io(occupied);
+        {
+            std::lock_guard<std::mutex> l(inputLock);
+            s.io(cycles);
+        }
+        s.io(aliveCount);
+        s.io(wallColor);
+        s.io(rng);
+        s.io(betweenRounds);
+        s.io(matchOver);
+        s.io(netWait);
+        s.io(netLast);
+        return occupied.size() == stride * rows;
+    }
+
+    int rows = 64;
+    int cols = 64;
+    int speed;
+    int rounds;
+
+    int stride = 1;
+    std::vector<uint64_t> occupied;
+    std::vector<Cycle> cycles;
+    int aliveCount = 0;
+    uint8_t wallColor = 0;
+
+    std::mutex inputLock;
+    std::minstd_rand rng{std::random_device{}()};
+    bool betweenRounds = false;
+    // the last round is won, GameOn goes once that's been shown
+    bool matchOver = false;
+
+    std::unique_ptr<FPPArcadeNetplay> net;
+    bool netStarted = false;
+    // frames to sit out, the pauses between rounds
+    int netWait = 0;
+    std::array<uint8_t, 2> netLast = {0, 0};
+    bool GameOn = true;
+    bool WaitingUntilOutput = false;
+};
+
+const std::string &FPPTron::getName() {
+    static const std::string name = "Tron";
+    return name;
+}
+
+void FPPTron::button(const std::string &button) {
+    playerButton(0, button);
+}
+
+void FPPTron::playerButton(int player, const std::string &button) {
+    TronEffect *effect = static_cast<TronEffect*>(getEffect());
+    if (effect) {
+        effect->button(player, button);
+        return;
+    }
+    PixelOverlayModel *m = resolveModel();
+    if (m != nullptr) {
+        FPPArcadeCanvas *canvas = createCanvas(m);
+        effect = new TronEffect(getOptions(), canvas);
+        if (getOptions().netplay.enabled) {
+            effect->startNetplay(getOptions().netplay);
+        }
+        startEffect(effect);
+    }
+}
+
+FPPArcadeGameEffect *FPPTron::createDemo(FPPArcadeCanvas *c) {
+    return new TronEffect(getOptions(), c);
+}
@@ -0,0 +1,38 @@
+#ifndef __FPPARCADE_TRON_
+#define __FPPARCADE_TRON_
+
+#include "FPPArcade.h"
+#include "FPPArcadeNetplay.h"
+
+class FPPTronOptions : public FPPArcadeGameOptions {
+public:
+    FPPTronOptions(const Json::Value &config);
+
+    int pixelScaling;
+    int players;
+    // ms per move
+    int speed;
+    // round wins needed to win the game
+    int rounds;
+    // one cycle each on two nodes, always two players
+    FPPArcadeNetplayOptions netplay;
+};
+
+class FPPTron : public FPPArcadeGame {
+public:
+    FPPTron(Json::Value &config, const std::shared_ptr<FPPArcadeGameOptions> &options);
+    virtual ~FPPTron();
+
+    virtual const std::string &getName() override;
+
+    virtual void button(const std::string &button) override;
+    virtual void playerButton(int player, const std::string &button) override;
+
+    const FPPTronOptions &getOptions() const { return static_cast<const FPPTronOptions&>(*options); }
+
+protected:
+    virtual FPPArcadeGameEffect *createDemo(FPPArcadeCanvas *c) override;
+};
+
+
+#endif
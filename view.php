@@ -0,0 +1,114 @@
+<div id="global" class="settings">
+<legend>FPP Arcade Viewer</legend>
+
+Model: <select id="viewModel" onChange="ConnectViewer();"></select>
+&nbsp;Zoom: <input type="number" id="viewZoom" value="4" min="1" max="16" onChange="ResizeViewer();"/>
+&nbsp;<span id="viewStatus"></span>
+<br>
+<canvas id="viewCanvas" width="1" height="1" style="image-rendering: pixelated; background: black;"></canvas>
+
+<script>
+var viewSocket = null;
+var viewImage = null;
+
+function ResizeViewer() {
+    if (viewImage == null) {
+        return;
+    }
+    var zoom = parseInt($("#viewZoom").val());
+    var c = document.getElementById("viewCanvas");
+    c.style.width = (viewImage.width * zoom) + "px";
+    c.style.height = (viewImage.height * zoom) + "px";
+}
+
+function ReadVarint(d, pos) {
+    var v = 0;
+    var shift = 0;
+    while (true) {
+        var b = d[pos.p++];
+        v |= (b & 0x7F) << shift;
+        if (b < 0x80) {
+            return v;
+        }
+        shift += 7;
+    }
+}
+
+function DrawFrame(buffer) {
+    var d = new Uint8Array(buffer);
+    var key = d[0] == 75; // 'K'
+    var w = d[1] | (d[2] << 8);
+    var h = d[3] | (d[4] << 8);
+    var c = document.getElementById("viewCanvas");
+    var ctx = c.getContext("2d");
+    if (viewImage == null || viewImage.width != w || viewImage.height != h) {
+        c.width = w;
+        c.height = h;
+        viewImage = ctx.createImageData(w, h);
+        ResizeViewer();
+    }
+    var px = viewImage.data;
+    if (key) {
+        for (var i = 0; i < px.length; i += 4) {
+            px[i] = px[i + 1] = px[i + 2] = 0;
+            px[i + 3] = 255;
+        }
+    }
+    var pos = {p: 9};
+    var idx = 0;
+    while (pos.p < d.length) {
+        idx += ReadVarint(d, pos);
+        var count = ReadVarint(d, pos);
+        var r = d[pos.p++];
+        var g = d[pos.p++];
+        var b = d[pos.p++];
+        for (var x = 0; x < count; x++, idx++) {
+            px[idx * 4] = r;
+            px[idx * 4 + 1] = g;
+            px[idx * 4 + 2] = b;
+            px[idx * 4 + 3] = 255;
+        }
+    }
+    ctx.putImageData(viewImage, 0, 0);
+}
+
+function ConnectViewer() {
+    if (viewSocket != null) {
+        viewSocket.close();
+    }
+    viewImage = null;
+    var model = $("#viewModel").val();
+    var proto = location.protocol == "https:" ? "wss://" : "ws://";
+    viewSocket = new WebSocket(proto + location.hostname + ":32322/arcade/view/" + encodeURIComponent(model));
+    viewSocket.binaryType = "arraybuffer";
+    viewSocket.onopen = function() {
+        $("#viewStatus").text("Connected");
+    };
+    viewSocket.onclose = function() {
+        $("#viewStatus").text("Disconnected");
+    };
+    viewSocket.onmessage = function(event) {
+        var s = this;
+        window.requestAnimationFrame(function() {
+            DrawFrame(event.data);
+            s.send("ack");
+        });
+    };
+}
+
+$.ajax({
+        url: "api/models",
+        type: 'GET',
+        async: false,
+        contentType: 'application/json',
+        success: function(data) {
+            data.forEach( function(item, index) {
+                $("#viewModel").append("<option value='" + item["Name"] + "'>" + item["Name"] + "</option>");
+            });
+        },
+        error: function() {
+        }
+});
+ConnectViewer();
+</script>
+</div>